@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Allocation-free biquad coefficient engine for the General Filter stage.
+
+    Coefficients are computed in place into preallocated storage (the same
+    formulas juce::dsp::IIR::Coefficients::make* uses) and handed to the
+    consumer through a lock-free triple buffer, so neither side ever touches
+    the heap.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Normalised second order coefficients (a0 == 1), in the same layout as
+// juce::dsp::IIR::Coefficients::getRawCoefficients(): b0, b1, b2, a1, a2
+struct BiquadCoefficients
+{
+    enum class Mode
+    {
+        Peak,
+        LowPass,
+        HighPass,
+        BandPass,
+        Notch,
+        AllPass,
+        END_OF_LIST
+    };
+
+    std::array<float, 5> raw{1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    bool operator==(const BiquadCoefficients &other) const noexcept { return raw == other.raw; }
+    bool operator!=(const BiquadCoefficients &other) const noexcept { return raw != other.raw; }
+
+    // Complex response at a frequency, for display
+    std::complex<double> getResponse(double frequency, double sampleRate) const noexcept
+    {
+        const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate); // z^-1
+        const auto [b0, b1, b2, a1, a2] = raw;
+
+        return (static_cast<double>(b0) + z * (static_cast<double>(b1) + z * static_cast<double>(b2))) /
+               (1.0 + z * (static_cast<double>(a1) + z * static_cast<double>(a2)));
+    }
+
+    // Computes the coefficients for the given mode in place, without allocating
+    void compute(Mode mode, double sampleRate, float frequency, float Q, float gainDb) noexcept
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0f);
+
+        const auto nyquistLimit = static_cast<float>(sampleRate * 0.5) * 0.999f;
+        frequency = juce::jlimit(1.0f, nyquistLimit, frequency);
+
+        if (mode == Mode::Peak)
+        {
+            const auto A = std::sqrt(juce::jmax(juce::Decibels::decibelsToGain(gainDb), 1.0e-6f));
+            const auto omega = (juce::MathConstants<float>::twoPi * frequency) / static_cast<float>(sampleRate);
+            const auto alpha = std::sin(omega) / (Q * 2.0f);
+            const auto c2 = -2.0f * std::cos(omega);
+            const auto alphaTimesA = alpha * A;
+            const auto alphaOverA = alpha / A;
+
+            set(1.0f + alphaTimesA, c2, 1.0f - alphaTimesA, 1.0f + alphaOverA, c2, 1.0f - alphaOverA);
+            return;
+        }
+
+        const auto n = 1.0f / std::tan(juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate));
+        const auto nSquared = n * n;
+        const auto invQ = 1.0f / Q;
+        const auto c1 = 1.0f / (1.0f + invQ * n + nSquared);
+        const auto a1 = c1 * 2.0f * (1.0f - nSquared);
+        const auto a2 = c1 * (1.0f - invQ * n + nSquared);
+
+        switch (mode)
+        {
+        case Mode::LowPass:
+            raw = {c1, c1 * 2.0f, c1, a1, a2};
+            break;
+        case Mode::HighPass:
+            raw = {c1 * nSquared, -2.0f * c1 * nSquared, c1 * nSquared, a1, a2};
+            break;
+        case Mode::BandPass:
+            raw = {c1 * n * invQ, 0.0f, -c1 * n * invQ, a1, a2};
+            break;
+        case Mode::Notch:
+            raw = {c1 * (1.0f + nSquared), a1, c1 * (1.0f + nSquared), a1, a2};
+            break;
+        case Mode::AllPass:
+            raw = {a2, a1, 1.0f, a1, a2};
+            break;
+        default:
+            jassertfalse;
+            break;
+        }
+    }
+
+private:
+    void set(float b0, float b1, float b2, float a0, float a1, float a2) noexcept
+    {
+        const auto a0Inv = 1.0f / a0;
+        raw = {b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv};
+    }
+};
+
+//==============================================================================
+// Single producer / single consumer triple buffer. The producer fills the
+// write slot and publishes it with one atomic exchange; the consumer picks up
+// the most recent publication with another. Neither side ever blocks.
+template <typename T>
+struct TripleBuffer
+{
+    T &getWriteBuffer() noexcept { return buffers[static_cast<size_t>(writeIndex)]; }
+
+    void publish() noexcept
+    {
+        auto previous = middle.exchange(writeIndex | dirtyFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Returns true (and swaps the newest value into the read slot) if something was published since the last call
+    bool pull() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & dirtyFlag) == 0)
+            return false;
+
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T &getReadBuffer() const noexcept { return buffers[static_cast<size_t>(readIndex)]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int dirtyFlag = 4;
+
+    std::array<T, 3> buffers{};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle{2};
+};
+
+//==============================================================================
+// Computes General Filter coefficients on demand and publishes them lock-free
+struct BiquadCoefficientEngine
+{
+    void prepare(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+    double getSampleRate() const noexcept { return sampleRate; }
+
+    // Producer side: recompute into the free slot and publish it
+    void update(BiquadCoefficients::Mode mode, float frequency, float Q, float gainDb) noexcept
+    {
+        if (sampleRate <= 0.0)
+            return;
+
+        auto &target = coefficients.getWriteBuffer();
+        target.compute(mode, sampleRate, frequency, Q, gainDb);
+        coefficients.publish();
+    }
+
+    // Producer side: publish coefficients that were computed elsewhere
+    void publish(const BiquadCoefficients &precomputed) noexcept
+    {
+        coefficients.getWriteBuffer() = precomputed;
+        coefficients.publish();
+    }
+
+    // Consumer side: copies the newest coefficients into destination.
+    // Returns false if nothing new was published.
+    bool pull(BiquadCoefficients &destination) noexcept
+    {
+        if (!coefficients.pull())
+            return false;
+
+        destination = coefficients.getReadBuffer();
+        return true;
+    }
+
+private:
+    double sampleRate = 0.0;
+    TripleBuffer<BiquadCoefficients> coefficients;
+};
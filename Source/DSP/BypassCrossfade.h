@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    Click-free bypass for a single processor.
+
+    Instead of switching a processor in or out instantly, BypassCrossfade
+    runs it alongside a copy of its input for the fade time and blends the
+    two with a linear ramp. A processor that fades back in from full bypass
+    is reset first, so it never resumes from stale state. All scratch space
+    is allocated in prepare().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct BypassCrossfade
+{
+    static constexpr double defaultFadeSeconds = 0.03;
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        dry.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+        gains.resize(spec.maximumBlockSize);
+        setSampleRate(spec.sampleRate);
+    }
+
+    // Both of these land on the current target straight away
+    void setSampleRate(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        wet.reset(sampleRate, fadeSeconds);
+    }
+
+    void setFadeSeconds(double newFadeSeconds) noexcept
+    {
+        fadeSeconds = newFadeSeconds;
+        wet.reset(sampleRate, fadeSeconds);
+    }
+
+    // Jumps to bypassed or active without fading (for a processor that is not audible yet)
+    void jumpTo(bool bypassed) noexcept { wet.setCurrentAndTargetValue(bypassed ? 0.0f : 1.0f); }
+
+    bool isFading() const noexcept { return wet.isSmoothing(); }
+
+    // Runs processWet(context) as needed for context.isBypassed, fading on changes.
+    // resetState() is called when the processor comes back from full bypass.
+    template <typename ProcessWet, typename ResetState>
+    void process(const juce::dsp::ProcessContextReplacing<float> &context, ProcessWet &&processWet, ResetState &&resetState) noexcept
+    {
+        const auto target = context.isBypassed ? 0.0f : 1.0f;
+
+        if (target != wet.getTargetValue())
+        {
+            if (target > 0.0f && wet.getCurrentValue() <= 0.0f)
+                resetState();
+
+            wet.setTargetValue(target);
+        }
+
+        auto block = context.getOutputBlock();
+        juce::dsp::ProcessContextReplacing<float> wetContext(block);
+
+        if (!wet.isSmoothing())
+        {
+            if (target > 0.0f)
+                processWet(wetContext);
+
+            return;
+        }
+
+        const auto numSamples = block.getNumSamples();
+        const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(dry.getNumChannels()));
+        const auto n = static_cast<int>(numSamples);
+
+        jassert(numSamples <= gains.size());
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::copy(dry.getWritePointer(static_cast<int>(ch)), block.getChannelPointer(ch), n);
+
+        processWet(wetContext);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            gains[i] = wet.getNextValue();
+
+        // out = dry + (wet - dry) * gain
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            auto *out = block.getChannelPointer(ch);
+            const auto *in = dry.getReadPointer(static_cast<int>(ch));
+
+            juce::FloatVectorOperations::subtract(out, in, n);
+            juce::FloatVectorOperations::multiply(out, gains.data(), n);
+            juce::FloatVectorOperations::add(out, in, n);
+        }
+    }
+
+private:
+    double sampleRate = 44100.0;
+    double fadeSeconds = defaultFadeSeconds;
+
+    juce::SmoothedValue<float> wet{1.0f};
+    juce::AudioBuffer<float> dry;
+    std::vector<float> gains;
+};
+
+// Processors that blend their own bypass (e.g. to keep it aligned with their latency)
+template <typename T>
+concept FadesOwnBypass = requires(T &processor, double seconds, bool bypassed) {
+    processor.setCrossfadeSeconds(seconds);
+    processor.jumpToBypass(bypassed);
+};
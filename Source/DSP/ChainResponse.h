@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+    Magnitude and phase response of the chain's linear stages, for the
+    editor.
+
+    The message thread describes the stages it wants drawn (the General
+    Filter's coefficients, the Ladder Filter's settings and the rate it
+    runs at) as a Request. Requests are keyed by a hash of those settings;
+    one matching the last request is dropped straight away, so a display
+    polling at its frame rate costs nothing while nothing moves. New ones
+    go to a background thread, which keeps each stage's curve in a small
+    cache keyed by the stage's own hash: dragging the ladder's cutoff only
+    recomputes the ladder, and flipping back to earlier settings recomputes
+    nothing. The audio thread is never involved.
+
+    The General Filter's response is exact. The ladder's is its small-signal
+    response (TieredLadderFilter::getSmallSignalResponse): the saturation
+    only matters once the signal is loud, where it mostly tames the
+    resonance. Time-varying and nonlinear stages (Phaser, Chorus,
+    WaveShaper) have no such response and are left out.
+
+    Like SpectrumAnalyzer, it is an EditorDisplayThread: the result is a
+    pair of paths, magnitude then phase, normalised to a unit square (y:
+    +-rangeDb or +-pi, 0 at the top).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCoefficients.h"
+#include "EditorDisplayThread.h"
+#include "TieredLadderFilter.h"
+
+class ChainResponse : public EditorDisplayThread
+{
+public:
+    static constexpr int numPoints = 256;
+    static constexpr float rangeDb = 24.0f;
+    static constexpr size_t maxStages = 8; // the longest chain
+    static constexpr size_t cacheSize = 16; // stage curves kept around
+
+    // One linear stage of the chain
+    struct Stage
+    {
+        enum class Type
+        {
+            Biquad,
+            Ladder
+        };
+
+        Type type = Type::Biquad;
+        double sampleRate = 0.0; // the rate the stage runs at (oversampled, for the ladder)
+
+        // Biquad
+        BiquadCoefficients coefficients;
+
+        // Ladder
+        float cutoffHz = 0.0f;
+        float resonance = 0.0f;
+        float drive = 1.0f;
+        TieredLadderFilter::Mode mode = TieredLadderFilter::Mode::LPF24;
+
+        // FNV-1a over the settings that shape this stage's curve
+        juce::uint64 getHash() const noexcept
+        {
+            auto hash = hashValue(offsetBasis, type);
+            hash = hashValue(hash, sampleRate);
+
+            if (type == Type::Biquad)
+                return hashValue(hash, coefficients.raw);
+
+            hash = hashValue(hash, cutoffHz);
+            hash = hashValue(hash, resonance);
+            hash = hashValue(hash, drive);
+            return hashValue(hash, mode);
+        }
+    };
+
+    // The linear stages in processing order, at the host rate
+    struct Request
+    {
+        double sampleRate = 0.0;
+        std::array<Stage, maxStages> stages{};
+        size_t numStages = 0;
+
+        void add(const Stage &stage) noexcept
+        {
+            if (numStages < stages.size())
+                stages[numStages++] = stage;
+        }
+
+        juce::uint64 getHash() const noexcept
+        {
+            auto hash = hashValue(offsetBasis, sampleRate);
+
+            for (size_t i = 0; i < numStages; ++i)
+                hash = hashValue(hash, stages[i].getHash());
+
+            return hashValue(hash, numStages);
+        }
+    };
+
+    ChainResponse() : EditorDisplayThread("Chain Response") {}
+    ~ChainResponse() override { stopThread(1000); }
+
+    // Message thread: hands the request to the background thread unless it matches the last one
+    void setRequest(const Request &request)
+    {
+        const auto hash = request.getHash();
+
+        if (!hasClients() || hash == lastRequestHash)
+            return;
+
+        lastRequestHash = hash;
+
+        {
+            const juce::ScopedLock lock(requestLock);
+            pendingRequest = request;
+            requestPending = true;
+        }
+
+        notify();
+    }
+
+    static float levelToY(float db) noexcept { return juce::jmap(db, -rangeDb, rangeDb, 1.0f, 0.0f); }
+
+    static float phaseToY(float radians) noexcept
+    {
+        return juce::jmap(radians, -juce::MathConstants<float>::pi, juce::MathConstants<float>::pi, 1.0f, 0.0f);
+    }
+
+private:
+    using Curve = std::array<std::complex<double>, numPoints>;
+
+    struct CacheEntry
+    {
+        juce::uint64 hash = 0;
+        juce::uint64 lastUsed = 0; // 0: empty
+        Curve curve{};
+    };
+
+    static constexpr juce::uint64 offsetBasis = 14695981039346656037ull;
+
+    template <typename T>
+    static juce::uint64 hashValue(juce::uint64 hash, const T &value) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        const auto *bytes = reinterpret_cast<const juce::uint8 *>(&value);
+
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    // A new client gets the current response even when it matches the last request
+    void clientsArrived() override { lastRequestHash = 0; }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            Request request;
+
+            {
+                const juce::ScopedLock lock(requestLock);
+
+                if (requestPending)
+                {
+                    request = pendingRequest;
+                    requestPending = false;
+                }
+            }
+
+            if (request.sampleRate > 0.0)
+                buildPaths(request);
+
+            wait(-1); // until the next request, or stopThread()
+        }
+    }
+
+    // The cached curve for a stage, computed into the least recently used entry on a miss
+    const Curve &getCurve(const Stage &stage)
+    {
+        const auto hash = stage.getHash();
+        auto *oldest = &cache.front();
+        ++useCounter;
+
+        for (auto &entry : cache)
+        {
+            if (entry.lastUsed != 0 && entry.hash == hash)
+            {
+                entry.lastUsed = useCounter;
+                return entry.curve;
+            }
+
+            if (entry.lastUsed < oldest->lastUsed)
+                oldest = &entry;
+        }
+
+        oldest->hash = hash;
+        oldest->lastUsed = useCounter;
+        computeCurve(stage, oldest->curve);
+        return oldest->curve;
+    }
+
+    static void computeCurve(const Stage &stage, Curve &curve)
+    {
+        TieredLadderFilter ladder;
+
+        if (stage.type == Stage::Type::Ladder)
+        {
+            ladder.setCutoffFrequencyHz(stage.cutoffHz);
+            ladder.setResonance(stage.resonance);
+            ladder.setDrive(stage.drive);
+            ladder.setMode(stage.mode);
+        }
+
+        for (int point = 0; point < numPoints; ++point)
+        {
+            const auto frequency = xToFrequency(static_cast<double>(point) / (numPoints - 1));
+
+            curve[static_cast<size_t>(point)] = stage.type == Stage::Type::Biquad
+                                                    ? stage.coefficients.getResponse(frequency, stage.sampleRate)
+                                                    : ladder.getSmallSignalResponse(frequency, stage.sampleRate);
+        }
+    }
+
+    void buildPaths(const Request &request)
+    {
+        Curve total;
+        total.fill(1.0);
+
+        for (size_t i = 0; i < request.numStages; ++i)
+        {
+            const auto &curve = getCurve(request.stages[i]);
+
+            for (size_t point = 0; point < total.size(); ++point)
+                total[point] *= curve[point];
+        }
+
+        // Up to the host Nyquist frequency; the phase starts a new sub-path where it wraps
+        const auto nyquist = request.sampleRate * 0.5;
+        juce::Path magnitude, phase;
+        magnitude.preallocateSpace(3 * numPoints);
+        phase.preallocateSpace(3 * numPoints);
+        auto lastPhase = 0.0f;
+
+        for (int point = 0; point < numPoints; ++point)
+        {
+            const auto x = static_cast<float>(point) / static_cast<float>(numPoints - 1);
+
+            if (xToFrequency(static_cast<double>(x)) >= nyquist)
+                break;
+
+            const auto &response = total[static_cast<size_t>(point)];
+            const auto db = juce::Decibels::gainToDecibels(static_cast<float>(std::abs(response)), -2.0f * rangeDb);
+            const auto magnitudeY = levelToY(juce::jlimit(-rangeDb, rangeDb, db));
+            const auto radians = static_cast<float>(std::arg(response));
+
+            if (point == 0)
+                magnitude.startNewSubPath(x, magnitudeY);
+            else
+                magnitude.lineTo(x, magnitudeY);
+
+            if (point == 0 || std::abs(radians - lastPhase) > juce::MathConstants<float>::pi)
+                phase.startNewSubPath(x, phaseToY(radians));
+            else
+                phase.lineTo(x, phaseToY(radians));
+
+            lastPhase = radians;
+        }
+
+        publishPaths(magnitude, phase);
+    }
+
+    // Message thread
+    juce::uint64 lastRequestHash = 0;
+
+    juce::CriticalSection requestLock;
+    Request pendingRequest;
+    bool requestPending = false;
+
+    // Background thread
+    std::array<CacheEntry, cacheSize> cache{};
+    juce::uint64 useCounter = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChainResponse)
+};
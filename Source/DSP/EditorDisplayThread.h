@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Shared plumbing for the editor's displays (SpectrumAnalyzer and
+    ChainResponse).
+
+    Each display does its work on a background thread that only runs while
+    at least one editor is registered with addClient(). The thread publishes
+    its result as a pair of paths normalised to a unit square, with x on a
+    log frequency axis from minFrequencyHz to maxFrequencyHz. The pair is
+    swapped in under a lock with a version number. Editors poll getPaths()
+    with the last version they drew, so an unchanged pair costs no copy.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class EditorDisplayThread : protected juce::Thread
+{
+public:
+    static constexpr float minFrequencyHz = 20.0f;
+    static constexpr float maxFrequencyHz = 20000.0f;
+
+    // Derived classes stop the thread in their own destructor, since run() uses their members
+    ~EditorDisplayThread() override { jassert(!isThreadRunning()); }
+
+    // Editors register while they are open; the thread only runs while at least one is. Message thread.
+    void addClient()
+    {
+        if (numClients++ == 0)
+        {
+            clientsArrived();
+            startThread(juce::Thread::Priority::low);
+        }
+    }
+
+    void removeClient()
+    {
+        jassert(numClients > 0);
+
+        if (--numClients == 0)
+        {
+            clientsLeft();
+            stopThread(1000);
+        }
+    }
+
+    // Message thread: copies the latest paths when they changed since lastVersion, and returns the new version
+    juce::uint32 getPaths(juce::uint32 lastVersion, juce::Path &first, juce::Path &second) const
+    {
+        const juce::ScopedLock lock(pathLock);
+
+        if (pathVersion != lastVersion)
+        {
+            first = paths[0];
+            second = paths[1];
+        }
+
+        return pathVersion;
+    }
+
+    // Normalised x of a frequency on the display's axis, for drawing a grid to match
+    static float frequencyToX(float frequencyHz) noexcept
+    {
+        return std::log(frequencyHz / minFrequencyHz) / std::log(maxFrequencyHz / minFrequencyHz);
+    }
+
+protected:
+    explicit EditorDisplayThread(const juce::String &threadName) : juce::Thread(threadName) {}
+
+    // Message thread: the first client arrived (before the thread starts), or the last one left (before it stops)
+    virtual void clientsArrived() {}
+    virtual void clientsLeft() {}
+
+    bool hasClients() const noexcept { return numClients > 0; }
+
+    template <typename Float>
+    static Float xToFrequency(Float x) noexcept
+    {
+        return static_cast<Float>(minFrequencyHz) * std::pow(static_cast<Float>(maxFrequencyHz / minFrequencyHz), x);
+    }
+
+    // Background thread: swaps in a new pair (leaving the previous one in first and second) and bumps the version
+    void publishPaths(juce::Path &first, juce::Path &second)
+    {
+        const juce::ScopedLock lock(pathLock);
+        paths[0].swapWithPath(first);
+        paths[1].swapWithPath(second);
+        ++pathVersion;
+    }
+
+private:
+    // Message thread
+    int numClients = 0;
+
+    juce::CriticalSection pathLock;
+    std::array<juce::Path, 2> paths;
+    juce::uint32 pathVersion = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(EditorDisplayThread)
+};
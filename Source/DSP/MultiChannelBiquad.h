@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Multi-channel biquad for the General Filter stage.
+
+    Every channel keeps its own filter state. Channels are packed into the
+    lanes of a juce::dsp::SIMDRegister, so a group of up to
+    SIMDRegister<float>::size() channels is filtered with one set of vector
+    operations per sample (transposed direct form II).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCoefficients.h"
+
+struct MultiChannelBiquad
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr size_t lanes = SIMDFloat::size();
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        numChannels = spec.numChannels;
+        numGroups = (numChannels + lanes - 1) / lanes;
+
+        state.resize(numGroups);
+        interleaved.resize(spec.maximumBlockSize);
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto &s : state)
+        {
+            s.s1 = SIMDFloat::expand(0.0f);
+            s.s2 = SIMDFloat::expand(0.0f);
+        }
+    }
+
+    void setCoefficients(const BiquadCoefficients &newCoefficients) noexcept
+    {
+        b0 = SIMDFloat::expand(newCoefficients.raw[0]);
+        b1 = SIMDFloat::expand(newCoefficients.raw[1]);
+        b2 = SIMDFloat::expand(newCoefficients.raw[2]);
+        a1 = SIMDFloat::expand(newCoefficients.raw[3]);
+        a2 = SIMDFloat::expand(newCoefficients.raw[4]);
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        auto &&outputBlock = context.getOutputBlock();
+        const auto numSamples = outputBlock.getNumSamples();
+        const auto blockChannels = juce::jmin(outputBlock.getNumChannels(), static_cast<size_t>(numChannels));
+
+        jassert(numSamples <= interleaved.size());
+
+        if (context.isBypassed)
+            return;
+
+        auto *lanesData = reinterpret_cast<float *>(interleaved.data());
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            const auto firstChannel = group * lanes;
+
+            if (firstChannel >= blockChannels)
+                break;
+
+            const auto groupChannels = juce::jmin(lanes, blockChannels - firstChannel);
+
+            // Interleave this group's channels into SIMD lanes (unused lanes stay silent)
+            if (groupChannels < lanes)
+                std::fill(lanesData, lanesData + numSamples * lanes, 0.0f);
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                const auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    lanesData[i * lanes + lane] = channel[i];
+            }
+
+            processInterleaved(state[group], numSamples);
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    channel[i] = lanesData[i * lanes + lane];
+            }
+        }
+    }
+
+private:
+    struct State
+    {
+        SIMDFloat s1, s2;
+    };
+
+    void processInterleaved(State &s, size_t numSamples) noexcept
+    {
+        auto s1 = s.s1;
+        auto s2 = s.s2;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = interleaved[i];
+            const auto y = b0 * x + s1;
+
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+
+            interleaved[i] = y;
+        }
+
+        s.s1 = s1;
+        s.s2 = s2;
+    }
+
+    SIMDFloat b0 = SIMDFloat::expand(1.0f);
+    SIMDFloat b1 = SIMDFloat::expand(0.0f);
+    SIMDFloat b2 = SIMDFloat::expand(0.0f);
+    SIMDFloat a1 = SIMDFloat::expand(0.0f);
+    SIMDFloat a2 = SIMDFloat::expand(0.0f);
+
+    size_t numChannels = 0;
+    size_t numGroups = 0;
+    std::vector<State> state;
+    std::vector<SIMDFloat> interleaved;
+};
@@ -0,0 +1,453 @@
+/*
+  ==============================================================================
+
+    Chorus / ensemble for the Chorus stage: 1 to 8 voices reading one
+    modulated delay line per channel, with feedback and a dry/wet mix. With
+    one voice and linear interpolation it behaves like juce::dsp::Chorus,
+    whose controls it keeps.
+
+    Voices are packed into the lanes of a juce::dsp::SIMDRegister, each
+    with its own LFO phase (spread by the golden ratio, so adding a voice
+    never moves the others). Odd channels (the right of each pair) can run
+    the LFOs ahead of even ones for a wider image (setStereoOffset); with
+    no offset every channel sweeps together, as juce::dsp::Chorus does.
+    The LFOs are quadrature oscillators rotated per sample, re-seeded from
+    an exact phase every block so they never drift. Taps are read with
+    linear, third-order Lagrange or first-order allpass (Thiran)
+    interpolation.
+
+    The voices are summed at equal power for the output, but the feedback
+    takes their average, so the loop gain never exceeds the feedback
+    setting however many voices line up. The delay line is shared by every
+    voice. Its memory is allocated in prepare() for maxCentreDelayMs (the
+    top of the parameter's range), but the voices only cycle through a
+    window sized from the current centre delay and depth: the next power
+    of two above the longest delay they reach. The window grows ahead of a
+    longer delay and shrinks once it is four times larger than needed, by
+    rearranging the line in place, so a short chorus keeps its few
+    kilobytes hot in cache and nothing is allocated on the audio thread.
+    Voice count changes fade voices in and out instead of switching them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct MultiVoiceChorus
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr size_t lanes = SIMDFloat::size();
+
+    static constexpr int maxVoices = 8;
+    static constexpr size_t maxVoiceGroups = (maxVoices + lanes - 1) / lanes;
+    static constexpr float minDelayMs = 1.0f;
+    static constexpr float maxCentreDelayMs = 100.0f;
+    static constexpr float maxModulationMs = 10.0f; // either side of the centre, at full depth
+    static constexpr float maxFeedback = 0.99f;     // keeps the loop strictly stable, even through the lossless allpass
+    static constexpr double maxStereoOffset = 0.5;  // of an LFO cycle, between even and odd channels
+
+    enum class Interpolation
+    {
+        Linear,
+        Lagrange3rd,
+        Thiran,
+        END_OF_LIST
+    };
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        sampleRate = spec.sampleRate;
+
+        // The longest delay the parameters allow, plus the taps read past it by the interpolators
+        lineCapacity = static_cast<size_t>(std::ceil((maxCentreDelayMs + maxModulationMs) * 0.001 * sampleRate)) + interpolationTaps;
+
+        channels.resize(spec.numChannels);
+
+        for (auto &channel : channels)
+            channel.line.assign(lineCapacity + interpolationTaps, 0.0f);
+
+        feedbackRamp.resize(spec.maximumBlockSize);
+        mixRamp.resize(spec.maximumBlockSize);
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto &channel : channels)
+        {
+            std::fill(channel.line.begin(), channel.line.end(), 0.0f);
+            channel.write = 0;
+            channel.lastFeedback = 0.0f;
+            channel.allpass.fill(SIMDFloat::expand(0.0f));
+        }
+
+        lineSize = getWindowSize(getLongestDelayMs());
+        lfoPhase = 0.0;
+        currentCentreMs = centreMs;
+        currentDepth = depth;
+        currentFeedback = feedback;
+        currentMix = mix;
+        currentGains = getVoiceGains(numVoices);
+        activeVoices = numVoices;
+    }
+
+    void setRate(float newRateHz) noexcept { rateHz = newRateHz; }
+
+    // 0 to 1
+    void setDepth(float newDepth) noexcept { depth = juce::jlimit(0.0f, 1.0f, newDepth); }
+
+    void setCentreDelay(float newCentreMs) noexcept { centreMs = juce::jlimit(minDelayMs, maxCentreDelayMs, newCentreMs); }
+
+    // -1 to 1
+    void setFeedback(float newFeedback) noexcept { feedback = juce::jlimit(-maxFeedback, maxFeedback, newFeedback); }
+
+    // 0 (dry) to 1 (wet)
+    void setMix(float newMix) noexcept { mix = juce::jlimit(0.0f, 1.0f, newMix); }
+
+    void setNumVoices(int newNumVoices) noexcept { numVoices = juce::jlimit(1, maxVoices, newNumVoices); }
+    int getNumVoices() const noexcept { return numVoices; }
+
+    // How far odd channels run ahead of even ones, in LFO cycles (0 to maxStereoOffset)
+    void setStereoOffset(double newOffset) noexcept { stereoOffset = juce::jlimit(0.0, maxStereoOffset, newOffset); }
+
+    void setInterpolation(Interpolation newInterpolation) noexcept
+    {
+        if (newInterpolation != interpolation)
+        {
+            // The allpass state means nothing to the other interpolators, and stale state would click
+            for (auto &channel : channels)
+                channel.allpass.fill(SIMDFloat::expand(0.0f));
+
+            interpolation = newInterpolation;
+        }
+    }
+
+    // The longest delay the voices reach at the current settings
+    float getLongestDelayMs() const noexcept { return centreMs + depth * maxModulationMs; }
+
+    // Samples per channel the voices currently cycle through (of the line allocated in prepare)
+    size_t getActiveWindowSize() const noexcept { return lineSize; }
+
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        auto &&outputBlock = context.getOutputBlock();
+        const auto numSamples = outputBlock.getNumSamples();
+        const auto blockChannels = juce::jmin(outputBlock.getNumChannels(), channels.size());
+
+        jassert(numSamples <= mixRamp.size());
+
+        if (context.isBypassed || numSamples == 0)
+            return;
+
+        prepareRamps(numSamples);
+        updateWindow();
+
+        // Voices fading out still need processing until the end of this block
+        const auto numGroups = (static_cast<size_t>(juce::jmax(numVoices, activeVoices)) + lanes - 1) / lanes;
+        const auto targetGains = getVoiceGains(numVoices);
+
+        switch (interpolation)
+        {
+        case Interpolation::Lagrange3rd:
+            processChannels<Interpolation::Lagrange3rd>(outputBlock, blockChannels, numSamples, numGroups, targetGains);
+            break;
+        case Interpolation::Thiran:
+            processChannels<Interpolation::Thiran>(outputBlock, blockChannels, numSamples, numGroups, targetGains);
+            break;
+        default:
+            processChannels<Interpolation::Linear>(outputBlock, blockChannels, numSamples, numGroups, targetGains);
+            break;
+        }
+
+        lfoPhase += static_cast<double>(rateHz) / sampleRate * static_cast<double>(numSamples);
+        lfoPhase -= std::floor(lfoPhase);
+
+        currentCentreMs = centreMs;
+        currentDepth = depth;
+        currentFeedback = feedback;
+        currentMix = mix;
+        currentGains = targetGains;
+        activeVoices = numVoices;
+    }
+
+private:
+    // Taps read beyond the integer delay: Lagrange reads one before and two after it
+    static constexpr size_t interpolationTaps = 4;
+
+    using VoiceRegisters = std::array<SIMDFloat, maxVoiceGroups>;
+
+    struct Channel
+    {
+        std::vector<float> line; // written backwards, with the first taps mirrored past the end
+        size_t write = 0;
+        float lastFeedback = 0.0f; // average of the voices
+        VoiceRegisters allpass; // Thiran state, per voice
+    };
+
+    // Equal power across the active voices, so the ensemble is as loud as one voice
+    static VoiceRegisters getVoiceGains(int voices) noexcept
+    {
+        VoiceRegisters gains;
+        const auto gain = 1.0f / std::sqrt(static_cast<float>(voices));
+
+        for (size_t group = 0; group < maxVoiceGroups; ++group)
+        {
+            for (size_t lane = 0; lane < lanes; ++lane)
+                gains[group].set(lane, static_cast<int>(group * lanes + lane) < voices ? gain : 0.0f);
+        }
+
+        return gains;
+    }
+
+    // Each voice's phase offset, independent of the voice count
+    static double getVoicePhase(size_t voice) noexcept
+    {
+        constexpr double goldenRatio = 0.6180339887498949;
+        const auto phase = static_cast<double>(voice) * goldenRatio;
+        return phase - std::floor(phase);
+    }
+
+    // The window for a delay: a power of two, so it changes rarely while a delay glides
+    size_t getWindowSize(float delayMs) const noexcept
+    {
+        const auto needed = static_cast<size_t>(std::ceil(delayMs * 0.001 * sampleRate)) + interpolationTaps;
+        return juce::jmin(lineCapacity, static_cast<size_t>(juce::nextPowerOfTwo(static_cast<int>(needed))));
+    }
+
+    // Grows the window before this block's ramps reach past it, or shrinks it once it is four times too
+    // large. The line is rotated in place so the newest sample sits at the start; growing zeroes the older
+    // samples the window never held, shrinking drops samples no voice can reach.
+    void updateWindow() noexcept
+    {
+        const auto longestMs = juce::jmax(currentCentreMs, centreMs) + juce::jmax(currentDepth, depth) * maxModulationMs;
+        const auto target = getWindowSize(longestMs);
+
+        if (target <= lineSize && target * 4 > lineSize)
+            return;
+
+        for (auto &channel : channels)
+        {
+            auto *line = channel.line.data();
+
+            std::rotate(line, line + channel.write, line + lineSize);
+
+            if (target > lineSize)
+                std::fill(line + lineSize, line + target, 0.0f);
+
+            std::copy(line, line + interpolationTaps, line + target);
+            channel.write = 0;
+        }
+
+        lineSize = target;
+    }
+
+    void prepareRamps(size_t numSamples) noexcept
+    {
+        const auto feedbackStep = (feedback - currentFeedback) / static_cast<float>(numSamples);
+        const auto mixStep = (mix - currentMix) / static_cast<float>(numSamples);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            feedbackRamp[i] = currentFeedback + feedbackStep * static_cast<float>(i + 1);
+            mixRamp[i] = currentMix + mixStep * static_cast<float>(i + 1);
+        }
+    }
+
+    template <Interpolation Type>
+    void processChannels(const juce::dsp::AudioBlock<float> &block, size_t blockChannels, size_t numSamples, size_t numGroups,
+                         const VoiceRegisters &targetGains) noexcept
+    {
+        const auto samplesPerMs = static_cast<float>(sampleRate * 0.001);
+        const auto inverseSamples = 1.0f / static_cast<float>(numSamples);
+        const auto angle = juce::MathConstants<double>::twoPi * static_cast<double>(rateHz) / sampleRate;
+        const auto rotationCos = static_cast<float>(std::cos(angle));
+        const auto rotationSin = static_cast<float>(std::sin(angle));
+        const auto minDelay = SIMDFloat::expand(minDelayMs * samplesPerMs);
+
+        // Centre and depth ramp across the block in samples, so the delays glide instead of stepping
+        const auto centreStart = currentCentreMs * samplesPerMs;
+        const auto centreStep = (centreMs - currentCentreMs) * samplesPerMs * inverseSamples;
+        const auto depthStart = currentDepth * maxModulationMs * samplesPerMs;
+        const auto depthStep = (depth - currentDepth) * maxModulationMs * samplesPerMs * inverseSamples;
+
+        VoiceRegisters gainSteps;
+        auto gainSumStart = 0.0f, gainSumEnd = 0.0f;
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            gainSteps[group] = (targetGains[group] - currentGains[group]) * inverseSamples;
+            gainSumStart += currentGains[group].sum();
+            gainSumEnd += targetGains[group].sum();
+        }
+
+        const auto gainSumStep = (gainSumEnd - gainSumStart) * inverseSamples;
+
+        for (size_t ch = 0; ch < blockChannels; ++ch)
+        {
+            auto &channel = channels[ch];
+            auto *data = block.getChannelPointer(ch);
+            auto *line = channel.line.data();
+            auto write = channel.write;
+            auto lastFeedback = channel.lastFeedback;
+            auto allpass = channel.allpass;
+            auto gains = currentGains;
+
+            // Seed each voice's oscillator from the exact phase
+            VoiceRegisters sine, cosine;
+            const auto channelPhase = lfoPhase + (ch % 2 == 1 ? stereoOffset : 0.0);
+
+            for (size_t group = 0; group < numGroups; ++group)
+            {
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    const auto phase = juce::MathConstants<double>::twoPi * (channelPhase + getVoicePhase(group * lanes + lane));
+                    sine[group].set(lane, static_cast<float>(std::sin(phase)));
+                    cosine[group].set(lane, static_cast<float>(std::cos(phase)));
+                }
+            }
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto input = data[i];
+
+                write = write == 0 ? lineSize - 1 : write - 1;
+                // The feedback is subtracted from the input, as in juce::dsp::Chorus
+                line[write] = input - lastFeedback * feedbackRamp[i];
+
+                if (write < interpolationTaps)
+                    line[write + lineSize] = line[write];
+
+                const auto centre = SIMDFloat::expand(centreStart + centreStep * static_cast<float>(i + 1));
+                const auto modulation = SIMDFloat::expand(depthStart + depthStep * static_cast<float>(i + 1));
+                auto wet = SIMDFloat::expand(0.0f);
+
+                for (size_t group = 0; group < numGroups; ++group)
+                {
+                    const auto delay = SIMDFloat::max(minDelay, centre + modulation * sine[group]);
+                    const auto voices = readVoices<Type>(line, write, delay, allpass[group]);
+
+                    gains[group] += gainSteps[group];
+                    wet += voices * gains[group];
+
+                    // Rotate the oscillators by one sample
+                    const auto s = sine[group];
+                    sine[group] = s * rotationCos + cosine[group] * rotationSin;
+                    cosine[group] = cosine[group] * rotationCos - s * rotationSin;
+                }
+
+                const auto wetSum = wet.sum();
+                lastFeedback = wetSum / (gainSumStart + gainSumStep * static_cast<float>(i + 1));
+                data[i] = input + (wetSum - input) * mixRamp[i];
+            }
+
+            channel.write = write;
+            channel.lastFeedback = lastFeedback;
+            channel.allpass = allpass;
+        }
+    }
+
+    // One interpolated tap per voice. Taps are gathered lane by lane; the interpolation runs across all lanes.
+    template <Interpolation Type>
+    SIMDFloat readVoices(const float *line, size_t write, SIMDFloat delay, SIMDFloat &allpassState) const noexcept
+    {
+        SIMDFloat fraction, tap0, tap1, tap2, tap3;
+
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            const auto samples = delay.get(lane);
+            auto whole = static_cast<size_t>(samples);
+            auto frac = samples - static_cast<float>(whole);
+
+            // Lagrange reads from one sample before the integer delay, Thiran keeps its fraction
+            // above 0.618 (as juce::dsp::DelayLine does) to stay clear of its pole at -1
+            if constexpr (Type == Interpolation::Lagrange3rd)
+            {
+                --whole;
+                frac += 1.0f;
+            }
+            else if constexpr (Type == Interpolation::Thiran)
+            {
+                if (frac < 0.618f)
+                {
+                    --whole;
+                    frac += 1.0f;
+                }
+            }
+
+            auto index = write + whole;
+
+            if (index >= lineSize)
+                index -= lineSize;
+
+            // Mirrored taps past the end, so these never wrap
+            const auto *taps = line + index;
+
+            fraction.set(lane, frac);
+            tap0.set(lane, taps[0]);
+            tap1.set(lane, taps[1]);
+
+            if constexpr (Type == Interpolation::Lagrange3rd)
+            {
+                tap2.set(lane, taps[2]);
+                tap3.set(lane, taps[3]);
+            }
+            else if constexpr (Type == Interpolation::Thiran)
+            {
+                // Allpass coefficient (1 - d) / (1 + d)
+                tap2.set(lane, (1.0f - frac) / (1.0f + frac));
+            }
+        }
+
+        if constexpr (Type == Interpolation::Lagrange3rd)
+        {
+            // Nodes at 0, 1, 2 and 3 samples past the first tap, fraction in [1, 2)
+            const auto d1 = fraction - 1.0f;
+            const auto d2 = fraction - 2.0f;
+            const auto d3 = fraction - 3.0f;
+
+            const auto c0 = d1 * d2 * d3 * (-1.0f / 6.0f);
+            const auto c1 = d2 * d3 * 0.5f;
+            const auto c2 = d1 * d3 * -0.5f;
+            const auto c3 = d1 * d2 * (1.0f / 6.0f);
+
+            return tap0 * c0 + fraction * (tap1 * c1 + tap2 * c2 + tap3 * c3);
+        }
+        else if constexpr (Type == Interpolation::Thiran)
+        {
+            allpassState = tap1 + tap2 * (tap0 - allpassState);
+            return allpassState;
+        }
+        else
+        {
+            return tap0 + (tap1 - tap0) * fraction;
+        }
+    }
+
+    double sampleRate = 44100.0;
+    size_t lineCapacity = 0; // allocated per channel, plus the mirrored taps
+    size_t lineSize = 0;     // the active window the write position wraps at
+
+    float rateHz = 1.0f;
+    float depth = 0.25f;
+    float centreMs = 7.0f;
+    float feedback = 0.0f;
+    float mix = 0.5f;
+    int numVoices = 1;
+    Interpolation interpolation = Interpolation::Linear;
+    double stereoOffset = 0.0;
+
+    double lfoPhase = 0.0;
+    float currentCentreMs = 7.0f;
+    float currentDepth = 0.25f;
+    float currentFeedback = 0.0f;
+    float currentMix = 0.5f;
+    VoiceRegisters currentGains{};
+    int activeVoices = 1;
+
+    std::vector<Channel> channels;
+    std::vector<float> feedbackRamp;
+    std::vector<float> mixRamp;
+};
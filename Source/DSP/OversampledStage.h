@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    Runs a nonlinear stage at 1x, 2x, 4x or 8x the host rate using
+    juce::dsp::Oversampling, with either polyphase IIR (low latency) or
+    equiripple FIR (linear phase) half-band filters.
+
+    Every factor/filter combination is allocated in prepare(), so switching
+    at runtime only re-prepares the wrapped processor at the new rate (which
+    must not allocate when the spec does not grow) and resets the chosen
+    oversampler. Neither happens abruptly: the stage fades out over half the
+    crossfade time, switches while silent and fades back in over the other
+    half, so the cleared filter and processor state never click.
+
+    Bypass is faded in the oversampled domain, between the resampled input
+    and the processed signal, so the blend stays aligned with the latency.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BypassCrossfade.h"
+
+template <typename Processor>
+struct OversampledStage
+{
+    enum class Factor
+    {
+        Off,
+        x2,
+        x4,
+        x8,
+        END_OF_LIST
+    };
+
+    enum class FilterType
+    {
+        PolyphaseIIR,
+        LinearPhaseFIR,
+        END_OF_LIST
+    };
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        baseSpec = spec;
+
+        for (size_t factor = 1; factor < numFactors; ++factor)
+        {
+            for (size_t type = 0; type < numFilterTypes; ++type)
+            {
+                auto filter = static_cast<FilterType>(type) == FilterType::PolyphaseIIR
+                                  ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                                  : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+                auto &oversampler = oversamplers[getIndex(static_cast<Factor>(factor), static_cast<FilterType>(type))];
+                oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, factor, filter, true, true);
+                oversampler->initProcessing(spec.maximumBlockSize);
+            }
+        }
+
+        // Size the processor and the fade for the largest rate first, so later switches never need to grow their buffers
+        processor.prepare(getSpecFor(Factor::x8));
+        bypassFade.prepare(getSpecFor(Factor::x8));
+
+        activeFactor = requestedFactor;
+        activeFilterType = requestedFilterType;
+        processor.prepare(getSpecFor(activeFactor));
+        bypassFade.setSampleRate(getSpecFor(activeFactor).sampleRate);
+
+        switchGains.resize(spec.maximumBlockSize);
+        switchGain.reset(spec.sampleRate, switchFadeSeconds);
+        switchGain.setCurrentAndTargetValue(1.0f);
+    }
+
+    void reset()
+    {
+        // Nothing is audible to fade, so a pending switch happens straight away
+        applyRequestedConfiguration();
+        switchGain.setCurrentAndTargetValue(1.0f);
+
+        processor.reset();
+
+        for (auto &oversampler : oversamplers)
+        {
+            if (oversampler != nullptr)
+                oversampler->reset();
+        }
+    }
+
+    void setOversampling(Factor newFactor, FilterType newFilterType) noexcept
+    {
+        requestedFactor = newFactor;
+        requestedFilterType = newFilterType;
+    }
+
+    void setCrossfadeSeconds(double seconds) noexcept
+    {
+        bypassFade.setFadeSeconds(seconds);
+
+        switchFadeSeconds = seconds * 0.5;
+        switchGain.reset(baseSpec.sampleRate, switchFadeSeconds);
+    }
+
+    void jumpToBypass(bool bypassed) noexcept { bypassFade.jumpTo(bypassed); }
+
+    // Latency (in host-rate samples) of the requested configuration
+    int getLatencySamples() const noexcept
+    {
+        if (requestedFactor == Factor::Off)
+            return 0;
+
+        const auto &oversampler = oversamplers[getIndex(requestedFactor, requestedFilterType)];
+        return oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+    }
+
+    // A bypassed context still runs the resampling filters (without the wrapped processor),
+    // so the stage's latency does not change when it is bypassed.
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        const auto switchRequested = requestedFactor != activeFactor || requestedFilterType != activeFilterType;
+
+        // Fade out towards a pending switch, or back in if it was withdrawn before the fade ended
+        if (switchGain.getTargetValue() != (switchRequested ? 0.0f : 1.0f))
+            switchGain.setTargetValue(switchRequested ? 0.0f : 1.0f);
+
+        if (switchRequested && !switchGain.isSmoothing())
+        {
+            applyRequestedConfiguration();
+            switchGain.setTargetValue(1.0f);
+        }
+
+        processStage(context);
+
+        if (switchGain.isSmoothing())
+            applySwitchGain(context.getOutputBlock());
+    }
+
+    Processor processor;
+
+private:
+    static constexpr size_t numFactors = static_cast<size_t>(Factor::END_OF_LIST);
+    static constexpr size_t numFilterTypes = static_cast<size_t>(FilterType::END_OF_LIST);
+
+    void processStage(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        const auto processWet = [this](const auto &wetContext) { processor.process(wetContext); };
+        const auto resetProcessor = [this] { processor.reset(); };
+
+        if (activeFactor == Factor::Off)
+        {
+            bypassFade.process(context, processWet, resetProcessor);
+            return;
+        }
+
+        auto block = context.getOutputBlock();
+        auto &oversampler = *oversamplers[getIndex(activeFactor, activeFilterType)];
+        auto oversampledBlock = oversampler.processSamplesUp(block);
+
+        juce::dsp::ProcessContextReplacing<float> oversampledContext(oversampledBlock);
+        oversampledContext.isBypassed = context.isBypassed;
+        bypassFade.process(oversampledContext, processWet, resetProcessor);
+
+        oversampler.processSamplesDown(block);
+    }
+
+    void applySwitchGain(const juce::dsp::AudioBlock<float> &block) noexcept
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto n = static_cast<int>(numSamples);
+
+        jassert(numSamples <= switchGains.size());
+
+        for (size_t i = 0; i < numSamples; ++i)
+            switchGains[i] = switchGain.getNextValue();
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::multiply(block.getChannelPointer(ch), switchGains.data(), n);
+    }
+
+    static size_t getIndex(Factor factor, FilterType filterType) noexcept
+    {
+        jassert(factor != Factor::Off);
+        return (static_cast<size_t>(factor) - 1) * numFilterTypes + static_cast<size_t>(filterType);
+    }
+
+    juce::dsp::ProcessSpec getSpecFor(Factor factor) const noexcept
+    {
+        const auto multiplier = 1u << static_cast<juce::uint32>(factor);
+        return {baseSpec.sampleRate * multiplier, baseSpec.maximumBlockSize * multiplier, baseSpec.numChannels};
+    }
+
+    void applyRequestedConfiguration() noexcept
+    {
+        if (requestedFactor == activeFactor && requestedFilterType == activeFilterType)
+            return;
+
+        if (requestedFactor != activeFactor)
+            processor.prepare(getSpecFor(requestedFactor));
+        else
+            processor.reset();
+
+        activeFactor = requestedFactor;
+        activeFilterType = requestedFilterType;
+        bypassFade.setSampleRate(getSpecFor(activeFactor).sampleRate);
+
+        if (activeFactor != Factor::Off)
+            oversamplers[getIndex(activeFactor, activeFilterType)]->reset();
+    }
+
+    juce::dsp::ProcessSpec baseSpec{44100.0, 512, 2};
+
+    Factor requestedFactor = Factor::Off;
+    FilterType requestedFilterType = FilterType::PolyphaseIIR;
+    Factor activeFactor = Factor::Off;
+    FilterType activeFilterType = FilterType::PolyphaseIIR;
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, (numFactors - 1) * numFilterTypes> oversamplers;
+    BypassCrossfade bypassFade;
+
+    // Fades the stage out and back in around factor and filter switches
+    double switchFadeSeconds = BypassCrossfade::defaultFadeSeconds * 0.5;
+    juce::SmoothedValue<float> switchGain{1.0f};
+    std::vector<float> switchGains;
+};
@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    Allocation and lock hooks for RealtimeChecker.h. Compiles to nothing
+    unless AUDIO_PLUGIN_RT_CHECK is set.
+
+  ==============================================================================
+*/
+
+#include "RealtimeChecker.h"
+
+#if AUDIO_PLUGIN_RT_CHECK
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+namespace RealtimeChecker
+{
+namespace
+{
+// Only print the first few traces; the counters keep going
+constexpr int maxReportedTraces = 16;
+
+// Plain thread_local ints need no dynamic initialisation, so they are safe to touch from inside operator new
+thread_local int audioThreadDepth = 0;
+thread_local bool reporting = false;
+
+std::array<std::atomic<int>, static_cast<size_t>(Violation::END_OF_LIST)> violationCounts{};
+std::atomic<int> reportedTraces{0};
+} // namespace
+
+ScopedAudioThread::ScopedAudioThread() noexcept { ++audioThreadDepth; }
+ScopedAudioThread::~ScopedAudioThread() noexcept { --audioThreadDepth; }
+
+void reportViolation(Violation kind) noexcept
+{
+    if (audioThreadDepth == 0 || reporting)
+        return;
+
+    // Whatever the report itself allocates or locks is not counted
+    reporting = true;
+
+    violationCounts[static_cast<size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+
+    if (reportedTraces.fetch_add(1, std::memory_order_relaxed) < maxReportedTraces)
+    {
+        const auto trace = juce::SystemStats::getStackBacktrace();
+        std::fprintf(stderr, "Real-time violation: %s on the audio thread\n%s\n", getViolationName(kind), trace.toRawUTF8());
+    }
+
+    reporting = false;
+}
+
+int getNumViolations(Violation kind) noexcept
+{
+    return violationCounts[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+int getTotalViolations() noexcept
+{
+    int total = 0;
+
+    for (auto &count : violationCounts)
+        total += count.load(std::memory_order_relaxed);
+
+    return total;
+}
+
+void resetViolations() noexcept
+{
+    for (auto &count : violationCounts)
+        count.store(0, std::memory_order_relaxed);
+
+    reportedTraces.store(0, std::memory_order_relaxed);
+}
+
+const char *getViolationName(Violation kind) noexcept
+{
+    switch (kind)
+    {
+    case Violation::Allocation: return "heap allocation";
+    case Violation::Deallocation: return "heap deallocation";
+    case Violation::Lock: return "blocking lock";
+    default: break;
+    }
+
+    return "unknown";
+}
+} // namespace RealtimeChecker
+
+//==============================================================================
+// Global allocation functions
+namespace
+{
+void *allocate(std::size_t size) noexcept
+{
+    RealtimeChecker::reportViolation(RealtimeChecker::Violation::Allocation);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+{
+    RealtimeChecker::reportViolation(RealtimeChecker::Violation::Allocation);
+    const auto align = juce::jmax(static_cast<std::size_t>(alignment), sizeof(void *));
+
+   #if JUCE_WINDOWS
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+   #else
+    void *result = nullptr;
+    return posix_memalign(&result, align, size == 0 ? 1 : size) == 0 ? result : nullptr;
+   #endif
+}
+
+void release(void *pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    RealtimeChecker::reportViolation(RealtimeChecker::Violation::Deallocation);
+    std::free(pointer);
+}
+
+void releaseAligned(void *pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    RealtimeChecker::reportViolation(RealtimeChecker::Violation::Deallocation);
+
+   #if JUCE_WINDOWS
+    _aligned_free(pointer);
+   #else
+    std::free(pointer);
+   #endif
+}
+
+void *allocateOrThrow(std::size_t size)
+{
+    if (auto *result = allocate(size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void *allocateAlignedOrThrow(std::size_t size, std::align_val_t alignment)
+{
+    if (auto *result = allocateAligned(size, alignment))
+        return result;
+
+    throw std::bad_alloc();
+}
+} // namespace
+
+void *operator new(std::size_t size) { return allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return allocateOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocateAligned(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void *pointer) noexcept { release(pointer); }
+void operator delete[](void *pointer) noexcept { release(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { release(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { release(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { releaseAligned(pointer); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { releaseAligned(pointer); }
+
+//==============================================================================
+// Blocking locks. std::mutex, juce::CriticalSection and friends all end up in pthread_mutex_lock here;
+// try-locks are not blocking and are left alone. Windows has no equivalent hook.
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+extern "C" int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    using LockFunction = int (*)(pthread_mutex_t *);
+
+    // Resolved lazily, since a static initialiser may lock before ours has run; a racy double lookup is harmless
+    static LockFunction realLock = nullptr;
+
+    if (realLock == nullptr)
+        realLock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+    RealtimeChecker::reportViolation(RealtimeChecker::Violation::Lock);
+    return realLock(mutex);
+}
+#endif
+
+#endif
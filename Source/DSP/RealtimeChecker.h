@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    Real-time safety checker for the audio thread.
+
+    Build with AUDIO_PLUGIN_RT_CHECK=1 to replace the global allocation
+    functions and (on Linux and macOS) pthread_mutex_lock with versions that
+    count and report, with a stack trace, every heap allocation,
+    deallocation and blocking lock taken while a ScopedAudioThread is alive
+    on the calling thread. processBlock holds one for its whole duration.
+
+    This is a debug/test mode only: the hooks cost a thread-local check on
+    every allocation and lock in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef AUDIO_PLUGIN_RT_CHECK
+ #define AUDIO_PLUGIN_RT_CHECK 0
+#endif
+
+#if AUDIO_PLUGIN_RT_CHECK
+namespace RealtimeChecker
+{
+enum class Violation
+{
+    Allocation,
+    Deallocation,
+    Lock,
+    END_OF_LIST
+};
+
+// Marks the calling thread as the audio thread while in scope (scopes may nest)
+struct ScopedAudioThread
+{
+    ScopedAudioThread() noexcept;
+    ~ScopedAudioThread() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+};
+
+// Counts a violation (and prints its stack trace) if the calling thread is marked
+void reportViolation(Violation kind) noexcept;
+
+int getNumViolations(Violation kind) noexcept;
+int getTotalViolations() noexcept;
+void resetViolations() noexcept;
+const char *getViolationName(Violation kind) noexcept;
+} // namespace RealtimeChecker
+#endif
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    A small pool of real-time worker threads that the audio thread can fan
+    independent tasks out to within one callback.
+
+    run() publishes a job (a function, its context and a task count) and
+    then claims tasks itself alongside the workers until none are left,
+    returning once every task has finished. Tasks are claimed with a
+    compare-and-swap on one word that holds the job's epoch, task count and
+    next index, so a worker waking late can never claim a task from a job
+    that has already moved on, and a worker that is descheduled or stopped
+    only means the calling thread runs more of the tasks itself. Nothing on
+    the calling side allocates or locks: waking the workers is an atomic
+    notify (a futex wake where the platform has one).
+
+    Workers run at real-time priority, each pinned to its own core (the
+    cores after the first, which hosts tend to favour for their own audio
+    thread). Pools hand out cores round-robin across the process, so the
+    workers of several plugin instances spread over the machine instead of
+    all landing on cores 1, 2, ... Between jobs they spin for
+    spinIterations polls, so a job that follows shortly finds them awake,
+    and then sleep on the wake counter.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <thread>
+
+class RealtimeWorkerPool
+{
+public:
+    static constexpr int maxWorkers = 15;
+    static constexpr int spinIterations = 4000;
+
+    using TaskFunction = void (*)(void *context, int taskIndex);
+
+    RealtimeWorkerPool() = default;
+    ~RealtimeWorkerPool() { stop(); }
+
+    // Replaces the workers with numWorkers new ones (none stops them). Not from the audio thread; audio may
+    // keep running, since run() finishes any tasks the workers leave behind.
+    void start(int numWorkers)
+    {
+        stop();
+
+        numWorkers = juce::jlimit(0, maxWorkers, numWorkers);
+
+        // This pool's first core, after the ones handed to the pools started before it
+        const auto firstCore = getNextCores().fetch_add(static_cast<juce::uint32>(numWorkers), std::memory_order_relaxed);
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto worker = std::make_unique<Worker>(*this, i, firstCore + static_cast<juce::uint32>(i));
+
+            // Without the rights to real-time scheduling, the highest normal priority will have to do
+            if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+                worker->startThread(juce::Thread::Priority::highest);
+
+            workers.push_back(std::move(worker));
+        }
+
+        activeWorkers.store(numWorkers, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        activeWorkers.store(0, std::memory_order_release);
+
+        if (workers.empty())
+            return;
+
+        for (auto &worker : workers)
+            worker->signalThreadShouldExit();
+
+        wakeCounter.fetch_add(1, std::memory_order_release);
+        wakeCounter.notify_all();
+
+        for (auto &worker : workers)
+            worker->stopThread(1000);
+
+        workers.clear();
+    }
+
+    // Safe from any thread
+    int getNumWorkers() const noexcept { return activeWorkers.load(std::memory_order_acquire); }
+
+    // Audio thread: runs task(context, i) for every i below numTasks, spread over the calling thread and the
+    // workers, and returns when all of them have finished. One caller at a time.
+    void run(int numTasks, TaskFunction task, void *context) noexcept
+    {
+        jassert(numTasks >= 0 && numTasks <= maxTasks);
+
+        if (numTasks <= 0)
+            return;
+
+        job.task = task;
+        job.context = context;
+        remaining.store(numTasks, std::memory_order_relaxed);
+
+        epoch = (epoch + 1) & epochMask;
+        claims.store(pack(epoch, static_cast<juce::uint64>(numTasks), 0), std::memory_order_release);
+
+        if (numTasks > 1 && getNumWorkers() > 0)
+        {
+            wakeCounter.fetch_add(1, std::memory_order_release);
+            wakeCounter.notify_all();
+        }
+
+        runTasks(epoch);
+
+        // Whatever is left is already running on a worker
+        for (int spins = 0; remaining.load(std::memory_order_acquire) > 0; ++spins)
+        {
+            if (spins >= spinIterations)
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr int maxTasks = 0xffff;
+    static constexpr juce::uint64 epochMask = 0xffffffffull;
+
+    // Claim word: epoch in the top 32 bits, then the task count and the next task index, 16 bits each
+    static constexpr juce::uint64 pack(juce::uint64 jobEpoch, juce::uint64 numTasks, juce::uint64 next) noexcept
+    {
+        return (jobEpoch << 32) | (numTasks << 16) | next;
+    }
+
+    struct Job
+    {
+        TaskFunction task = nullptr;
+        void *context = nullptr;
+    };
+
+    // Shared by every pool in the process
+    static std::atomic<juce::uint32> &getNextCores() noexcept
+    {
+        static std::atomic<juce::uint32> nextCores{0};
+        return nextCores;
+    }
+
+    struct Worker : juce::Thread
+    {
+        Worker(RealtimeWorkerPool &ownerPool, int workerIndex, juce::uint32 workerCore)
+            : juce::Thread("Realtime Worker " + juce::String(workerIndex + 1)), pool(ownerPool), core(workerCore)
+        {
+        }
+
+        void run() override
+        {
+            // Pinned to the core it was handed, skipping the first
+            const auto numCpus = juce::jmin(32, juce::SystemStats::getNumCpus());
+
+            if (numCpus > 1)
+                juce::Thread::setCurrentThreadAffinityMask(1u << (1 + core % static_cast<juce::uint32>(numCpus - 1)));
+
+            auto seen = pool.wakeCounter.load(std::memory_order_acquire);
+
+            while (!threadShouldExit())
+            {
+                auto spins = 0;
+
+                while (pool.wakeCounter.load(std::memory_order_acquire) == seen && spins++ < spinIterations)
+                    ;
+
+                pool.wakeCounter.wait(seen, std::memory_order_acquire);
+                seen = pool.wakeCounter.load(std::memory_order_acquire);
+
+                if (threadShouldExit())
+                    break;
+
+                pool.runTasks(pool.claims.load(std::memory_order_acquire) >> 32);
+            }
+        }
+
+        RealtimeWorkerPool &pool;
+        const juce::uint32 core;
+    };
+
+    // Claims and runs tasks of the given job until it has none left to hand out
+    void runTasks(juce::uint64 jobEpoch) noexcept
+    {
+        auto current = claims.load(std::memory_order_acquire);
+
+        while (true)
+        {
+            const auto numTasks = (current >> 16) & 0xffff;
+            const auto next = current & 0xffff;
+
+            if ((current >> 32) != jobEpoch || next >= numTasks)
+                return;
+
+            if (!claims.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+
+            // The job cannot move on while this task is unfinished, so its fields are stable here
+            job.task(job.context, static_cast<int>(next));
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+            current = claims.load(std::memory_order_acquire);
+        }
+    }
+
+    // Calling side
+    Job job;
+    juce::uint64 epoch = 0;
+
+    // Shared
+    std::atomic<juce::uint64> claims{0};
+    std::atomic<int> remaining{0};
+    std::atomic<juce::uint32> wakeCounter{0};
+    std::atomic<int> activeWorkers{0};
+
+    // Message thread
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorkerPool)
+};
@@ -0,0 +1,317 @@
+/*
+  ==============================================================================
+
+    Saturation kernels for the WaveShaper stage.
+
+    Each curve is a plain type with a scalar and a SIMD overload of apply(),
+    so SaturationKernel<Curve> is fully inlined for a statically known curve
+    and runs over whole blocks in juce::dsp::SIMDRegister sized chunks,
+    straight from the (aligned) channel data. WaveShaperStage picks the
+    kernel once per block and applies a smoothed drive ahead of it.
+
+    TanhApprox, HardClip and SoftClip are vector code throughout (the divide
+    uses the native instruction). TanhTable is vector code apart from the
+    two table reads per lane, which SIMDRegister cannot gather. Exact Tanh
+    stays scalar: it calls std::tanh once per lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace SaturationCurves
+{
+using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+// Applies a scalar function to every lane (used where there is no vector equivalent, e.g. std::tanh)
+template <typename Fn>
+inline SIMDFloat perLane(SIMDFloat v, Fn &&fn) noexcept
+{
+    alignas(alignof(SIMDFloat)) float values[SIMDFloat::size()];
+    v.copyToRawArray(values);
+
+    for (auto &value : values)
+        value = fn(value);
+
+    return SIMDFloat::fromRawArray(values);
+}
+
+// SIMDRegister has no division, so this goes to the native instruction (a refined reciprocal on 32-bit ARM)
+inline SIMDFloat divide(SIMDFloat numerator, SIMDFloat denominator) noexcept
+{
+#if JUCE_USE_SSE_INTRINSICS
+    return SIMDFloat(_mm_div_ps(numerator.value, denominator.value));
+#elif JUCE_USE_ARM_NEON && defined(__aarch64__)
+    return SIMDFloat(vdivq_f32(numerator.value, denominator.value));
+#elif JUCE_USE_ARM_NEON
+    auto reciprocal = vrecpeq_f32(denominator.value);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator.value, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator.value, reciprocal), reciprocal);
+    return SIMDFloat(vmulq_f32(numerator.value, reciprocal));
+#else
+    alignas(alignof(SIMDFloat)) float n[SIMDFloat::size()];
+    alignas(alignof(SIMDFloat)) float d[SIMDFloat::size()];
+    numerator.copyToRawArray(n);
+    denominator.copyToRawArray(d);
+
+    for (size_t i = 0; i < SIMDFloat::size(); ++i)
+        n[i] /= d[i];
+
+    return SIMDFloat::fromRawArray(n);
+#endif
+}
+
+// Exact std::tanh, one lane at a time
+struct Tanh
+{
+    static float apply(float x) noexcept { return std::tanh(x); }
+    static SIMDFloat apply(SIMDFloat x) noexcept { return perLane(x, [](float v) { return std::tanh(v); }); }
+};
+
+// Pade 7/6 rational approximation of tanh (the same one as juce::dsp::FastMathApproximations::tanh),
+// clamped to the range where it stays within [-1, 1]
+struct TanhApprox
+{
+    static constexpr float limit = 5.0f;
+
+    template <typename T>
+    static T numerator(T x, T x2) noexcept { return x * (x2 * (x2 * (x2 + 378.0f) + 17325.0f) + 135135.0f); }
+
+    template <typename T>
+    static T denominator(T x2) noexcept { return x2 * (x2 * (x2 * 28.0f + 3150.0f) + 62370.0f) + 135135.0f; }
+
+    static float apply(float x) noexcept
+    {
+        x = juce::jlimit(-limit, limit, x);
+        const auto x2 = x * x;
+        return juce::jlimit(-1.0f, 1.0f, numerator(x, x2) / denominator(x2));
+    }
+
+    static SIMDFloat apply(SIMDFloat x) noexcept
+    {
+        x = SIMDFloat::min(SIMDFloat::max(x, SIMDFloat::expand(-limit)), SIMDFloat::expand(limit));
+        const auto x2 = x * x;
+        const auto y = divide(numerator(x, x2), denominator(x2));
+        return SIMDFloat::min(SIMDFloat::max(y, SIMDFloat::expand(-1.0f)), SIMDFloat::expand(1.0f));
+    }
+};
+
+// Linearly interpolated tanh lookup table over [-limit, limit]
+struct TanhTable
+{
+    static constexpr float limit = 5.0f;
+    static constexpr int size = 2048;
+
+    // Builds the table on first use; call once off the audio thread to avoid the one-off initialisation there
+    static const std::array<float, size + 1> &getTable()
+    {
+        static const auto table = []
+        {
+            std::array<float, size + 1> t{};
+
+            for (int i = 0; i <= size; ++i)
+                t[static_cast<size_t>(i)] = std::tanh(-limit + 2.0f * limit * static_cast<float>(i) / static_cast<float>(size));
+
+            return t;
+        }();
+
+        return table;
+    }
+
+    static float apply(float x) noexcept
+    {
+        constexpr auto scale = static_cast<float>(size) / (2.0f * limit);
+        const auto &table = getTable();
+
+        const auto position = (juce::jlimit(-limit, limit, x) + limit) * scale;
+        const auto index = juce::jmin(static_cast<int>(position), size - 1);
+        const auto fraction = position - static_cast<float>(index);
+        const auto y0 = table[static_cast<size_t>(index)];
+
+        return y0 + fraction * (table[static_cast<size_t>(index) + 1] - y0);
+    }
+
+    // The position, index and interpolation are vector code; only the two table reads go lane by lane
+    static SIMDFloat apply(SIMDFloat x) noexcept
+    {
+        constexpr auto scale = static_cast<float>(size) / (2.0f * limit);
+        const auto &table = getTable();
+
+        x = SIMDFloat::min(SIMDFloat::max(x, SIMDFloat::expand(-limit)), SIMDFloat::expand(limit));
+        const auto position = (x + SIMDFloat::expand(limit)) * SIMDFloat::expand(scale);
+        const auto index = SIMDFloat::min(SIMDFloat::truncate(position), SIMDFloat::expand(static_cast<float>(size - 1)));
+        const auto fraction = position - index;
+
+        alignas(alignof(SIMDFloat)) float indices[SIMDFloat::size()];
+        alignas(alignof(SIMDFloat)) float y0[SIMDFloat::size()];
+        alignas(alignof(SIMDFloat)) float y1[SIMDFloat::size()];
+        index.copyToRawArray(indices);
+
+        for (size_t lane = 0; lane < SIMDFloat::size(); ++lane)
+        {
+            const auto i = static_cast<size_t>(indices[lane]);
+            y0[lane] = table[i];
+            y1[lane] = table[i + 1];
+        }
+
+        const auto low = SIMDFloat::fromRawArray(y0);
+        return low + fraction * (SIMDFloat::fromRawArray(y1) - low);
+    }
+};
+
+// Hard clip to [-1, 1]
+struct HardClip
+{
+    static float apply(float x) noexcept { return juce::jlimit(-1.0f, 1.0f, x); }
+
+    static SIMDFloat apply(SIMDFloat x) noexcept
+    {
+        return SIMDFloat::min(SIMDFloat::max(x, SIMDFloat::expand(-1.0f)), SIMDFloat::expand(1.0f));
+    }
+};
+
+// Cubic soft clip, 1.5 * (x - x^3 / 3) on [-1, 1]
+struct SoftClip
+{
+    template <typename T>
+    static T polynomial(T x) noexcept { return x * ((x * x) * -0.5f + 1.5f); }
+
+    static float apply(float x) noexcept { return polynomial(juce::jlimit(-1.0f, 1.0f, x)); }
+
+    static SIMDFloat apply(SIMDFloat x) noexcept
+    {
+        return polynomial(SIMDFloat::min(SIMDFloat::max(x, SIMDFloat::expand(-1.0f)), SIMDFloat::expand(1.0f)));
+    }
+};
+} // namespace SaturationCurves
+
+//==============================================================================
+// Applies a statically known curve in place over a whole channel: scalar up to the first SIMD-aligned
+// sample, whole registers loaded and stored in place from there, and scalar again for the remainder
+template <typename Curve>
+struct SaturationKernel
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr size_t lanes = SIMDFloat::size();
+
+    static void process(float *data, size_t numSamples) noexcept
+    {
+        const auto head = juce::jmin(numSamples, static_cast<size_t>(SIMDFloat::getNextSIMDAlignedPtr(data) - data));
+        size_t i = 0;
+
+        for (; i < head; ++i)
+            data[i] = Curve::apply(data[i]);
+
+        for (; i + lanes <= numSamples; i += lanes)
+            Curve::apply(SIMDFloat::fromRawArray(data + i)).copyToRawArray(data + i);
+
+        for (; i < numSamples; ++i)
+            data[i] = Curve::apply(data[i]);
+    }
+};
+
+//==============================================================================
+// WaveShaper stage: smoothed drive followed by the selected saturation kernel
+struct WaveShaperStage
+{
+    enum class Curve
+    {
+        Tanh,
+        TanhApprox,
+        TanhTable,
+        HardClip,
+        SoftClip,
+        END_OF_LIST
+    };
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        SaturationCurves::TanhTable::getTable(); // build the table off the audio thread
+
+        drive.reset(spec.sampleRate, driveRampSeconds);
+        drive.setCurrentAndTargetValue(drive.getTargetValue());
+        driveRamp.resize(spec.maximumBlockSize);
+    }
+
+    void reset()
+    {
+        drive.setCurrentAndTargetValue(drive.getTargetValue());
+    }
+
+    void setDrive(float newDrive) noexcept { drive.setTargetValue(newDrive); }
+
+    void setCurve(Curve newCurve) noexcept { curve = newCurve; }
+
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        if (context.isBypassed)
+            return;
+
+        auto &&block = context.getOutputBlock();
+        const auto numSamples = block.getNumSamples();
+        const auto numChannels = block.getNumChannels();
+
+        jassert(numSamples <= driveRamp.size());
+
+        applyDrive(block, numSamples, numChannels);
+
+        switch (curve)
+        {
+        case Curve::Tanh:
+            processChannels<SaturationCurves::Tanh>(block, numSamples, numChannels);
+            break;
+        case Curve::TanhApprox:
+            processChannels<SaturationCurves::TanhApprox>(block, numSamples, numChannels);
+            break;
+        case Curve::TanhTable:
+            processChannels<SaturationCurves::TanhTable>(block, numSamples, numChannels);
+            break;
+        case Curve::HardClip:
+            processChannels<SaturationCurves::HardClip>(block, numSamples, numChannels);
+            break;
+        case Curve::SoftClip:
+            processChannels<SaturationCurves::SoftClip>(block, numSamples, numChannels);
+            break;
+        default:
+            break;
+        }
+    }
+
+private:
+    static constexpr double driveRampSeconds = 0.02;
+
+    void applyDrive(const juce::dsp::AudioBlock<float> &block, size_t numSamples, size_t numChannels) noexcept
+    {
+        const auto n = static_cast<int>(numSamples);
+
+        if (!drive.isSmoothing())
+        {
+            const auto gain = drive.getTargetValue();
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::multiply(block.getChannelPointer(ch), gain, n);
+
+            return;
+        }
+
+        // One ramp for all channels, so every channel sees the same drive trajectory
+        for (size_t i = 0; i < numSamples; ++i)
+            driveRamp[i] = drive.getNextValue();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::multiply(block.getChannelPointer(ch), driveRamp.data(), n);
+    }
+
+    template <typename CurveType>
+    static void processChannels(const juce::dsp::AudioBlock<float> &block, size_t numSamples, size_t numChannels) noexcept
+    {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            SaturationKernel<CurveType>::process(block.getChannelPointer(ch), numSamples);
+    }
+
+    Curve curve = Curve::Tanh;
+    juce::SmoothedValue<float> drive{1.0f};
+    std::vector<float> driveRamp;
+};
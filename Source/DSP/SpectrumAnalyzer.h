@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+    Pre/post spectrum analysis for the editor.
+
+    The audio thread only mixes each block down to mono and copies it into
+    fixed-size chunks (input and output side by side, so the two stay
+    aligned), which go to a background thread through a SimpleMBComp::Fifo.
+    Full chunks are dropped when the FIFO is full, so the audio-thread cost
+    is a copy per sample whatever the thread is doing, and nothing at all
+    while no editor is watching.
+
+    The background thread keeps the last fftSize samples of each side and,
+    at most frameRateHz times a second, windows them, runs the FFT, smooths
+    the levels and turns them into a Path per side with a fixed number of
+    points. It is an EditorDisplayThread, so the pair (pre, then post) is
+    normalised to a unit square (y: level, 0 at the top) and every open
+    editor draws it scaled to its own bounds; the analysis runs once
+    however many editors there are.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <Fifo.h>
+#include "EditorDisplayThread.h"
+
+class SpectrumAnalyzer : public EditorDisplayThread
+{
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int chunkSize = 512;
+    static constexpr int frameRateHz = 30;
+    static constexpr int numPathPoints = 256;
+    static constexpr float minDb = -96.0f;
+    static constexpr float maxDb = 6.0f;
+    static constexpr float releaseDbPerSecond = 48.0f; // levels rise at once and fall at this rate
+
+    enum class Trace
+    {
+        Pre,
+        Post,
+        END_OF_LIST
+    };
+
+    SpectrumAnalyzer() : EditorDisplayThread("Spectrum Analyzer") {}
+    ~SpectrumAnalyzer() override { stopThread(1000); }
+
+    // Message thread, with the audio stopped
+    void prepare(double newSampleRate, int maximumBlockSize)
+    {
+        const auto wasRunning = isThreadRunning();
+        stopThread(1000);
+
+        sampleRate.store(newSampleRate);
+        inputMix.resize(static_cast<size_t>(juce::jmax(1, maximumBlockSize)));
+        chunk.setSize(numTraces, chunkSize);
+        chunkPosition = 0;
+        chunks.prepare(numTraces, chunkSize);
+
+        if (wasRunning)
+            startThread(juce::Thread::Priority::low);
+    }
+
+    // Audio thread: the block as it came in, before any processing
+    void pushInput(const juce::AudioBuffer<float> &buffer) noexcept
+    {
+        if (active.load(std::memory_order_relaxed))
+            mixDown(buffer, inputMix.data());
+    }
+
+    // Audio thread: the same block once processed. Pairs it with the input from pushInput().
+    void pushOutput(const juce::AudioBuffer<float> &buffer) noexcept
+    {
+        if (!active.load(std::memory_order_relaxed))
+            return;
+
+        const auto numSamples = juce::jmin(buffer.getNumSamples(), static_cast<int>(inputMix.size()));
+        auto *outputMix = chunk.getWritePointer(static_cast<int>(Trace::Post));
+
+        for (int start = 0; start < numSamples;)
+        {
+            const auto length = juce::jmin(numSamples - start, chunkSize - chunkPosition);
+
+            chunk.copyFrom(static_cast<int>(Trace::Pre), chunkPosition, inputMix.data() + start, length);
+            mixDown(buffer, outputMix + chunkPosition, start, length);
+
+            start += length;
+            chunkPosition += length;
+
+            if (chunkPosition == chunkSize)
+            {
+                chunks.push(chunk); // dropped if the analysis thread fell behind
+                chunkPosition = 0;
+            }
+        }
+    }
+
+    static float levelToY(float db) noexcept { return juce::jmap(db, minDb, maxDb, 1.0f, 0.0f); }
+
+private:
+    static constexpr int numTraces = static_cast<int>(Trace::END_OF_LIST);
+
+    // The audio thread only feeds the analysis while an editor is watching
+    void clientsArrived() override
+    {
+        resetLevels();
+        active.store(true);
+    }
+
+    void clientsLeft() override { active.store(false); }
+
+    void mixDown(const juce::AudioBuffer<float> &buffer, float *destination, int start = 0, int length = -1) const noexcept
+    {
+        const auto numChannels = buffer.getNumChannels();
+
+        if (length < 0)
+            length = juce::jmin(buffer.getNumSamples(), static_cast<int>(inputMix.size()));
+
+        if (numChannels == 0)
+        {
+            juce::FloatVectorOperations::clear(destination, length);
+            return;
+        }
+
+        juce::FloatVectorOperations::multiply(destination, buffer.getReadPointer(0, start), 1.0f / static_cast<float>(numChannels), length);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(ch, start),
+                                                         1.0f / static_cast<float>(numChannels), length);
+    }
+
+    void resetLevels()
+    {
+        for (auto &trace : history)
+            std::fill(trace.begin(), trace.end(), 0.0f);
+
+        for (auto &trace : levels)
+            std::fill(trace.begin(), trace.end(), minDb);
+
+        historyPosition = 0;
+    }
+
+    void run() override
+    {
+        juce::AudioBuffer<float> received(numTraces, chunkSize);
+
+        while (!threadShouldExit())
+        {
+            auto updated = false;
+
+            while (chunks.pull(received))
+            {
+                appendToHistory(received);
+                updated = true;
+            }
+
+            if (updated)
+            {
+                std::array<juce::Path, numTraces> newPaths;
+
+                for (size_t trace = 0; trace < newPaths.size(); ++trace)
+                {
+                    analyse(trace);
+                    buildPath(trace, newPaths[trace]);
+                }
+
+                publishPaths(newPaths[static_cast<size_t>(Trace::Pre)], newPaths[static_cast<size_t>(Trace::Post)]);
+            }
+
+            wait(1000 / frameRateHz);
+        }
+    }
+
+    void appendToHistory(const juce::AudioBuffer<float> &received)
+    {
+        for (size_t trace = 0; trace < history.size(); ++trace)
+        {
+            const auto *source = received.getReadPointer(static_cast<int>(trace));
+            auto &line = history[trace];
+
+            for (int i = 0; i < chunkSize; ++i)
+                line[(historyPosition + static_cast<size_t>(i)) % line.size()] = source[i];
+        }
+
+        historyPosition = (historyPosition + static_cast<size_t>(chunkSize)) % static_cast<size_t>(fftSize);
+    }
+
+    // Windowed FFT of the newest fftSize samples into levels[trace], in dB with the release applied
+    void analyse(size_t trace)
+    {
+        const auto &line = history[trace];
+
+        for (size_t i = 0; i < line.size(); ++i)
+            fftData[i] = line[(historyPosition + i) % line.size()];
+
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+        window.multiplyWithWindowingTable(fftData.data(), fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        // A full-scale sine peaks at fftSize / 4 through the Hann window
+        const auto scale = 4.0f / static_cast<float>(fftSize);
+        const auto release = releaseDbPerSecond / static_cast<float>(frameRateHz);
+        auto &level = levels[trace];
+
+        for (size_t bin = 0; bin < level.size(); ++bin)
+        {
+            const auto db = juce::jmax(minDb, juce::Decibels::gainToDecibels(fftData[bin] * scale, minDb));
+            level[bin] = juce::jmax(db, level[bin] - release);
+        }
+    }
+
+    // numPathPoints points on the log frequency axis, each the loudest bin it covers
+    void buildPath(size_t trace, juce::Path &path) const
+    {
+        const auto &level = levels[trace];
+        const auto binsPerHz = static_cast<float>(fftSize) / static_cast<float>(sampleRate.load());
+        const auto lastBin = static_cast<float>(level.size() - 1);
+        const auto halfStep = 0.5f / static_cast<float>(numPathPoints - 1);
+
+        path.preallocateSpace(3 * numPathPoints);
+
+        for (int point = 0; point < numPathPoints; ++point)
+        {
+            const auto x = static_cast<float>(point) / static_cast<float>(numPathPoints - 1);
+            const auto loBin = juce::jlimit(0.0f, lastBin, xToFrequency(x - halfStep) * binsPerHz);
+            const auto hiBin = juce::jlimit(0.0f, lastBin, xToFrequency(x + halfStep) * binsPerHz);
+
+            // Where a point covers less than a bin, interpolate between the two around its centre
+            auto db = minDb;
+
+            if (hiBin - loBin < 1.0f)
+            {
+                const auto centre = juce::jlimit(0.0f, lastBin, xToFrequency(x) * binsPerHz);
+                const auto below = static_cast<size_t>(centre);
+                const auto above = juce::jmin(below + 1, level.size() - 1);
+                db = juce::jmap(centre - static_cast<float>(below), level[below], level[above]);
+            }
+            else
+            {
+                for (auto bin = static_cast<size_t>(std::ceil(loBin)); bin <= static_cast<size_t>(hiBin); ++bin)
+                    db = juce::jmax(db, level[bin]);
+            }
+
+            const auto y = levelToY(juce::jlimit(minDb, maxDb, db));
+
+            if (point == 0)
+                path.startNewSubPath(x, y);
+            else
+                path.lineTo(x, y);
+        }
+    }
+
+    // Shared
+    std::atomic<bool> active{false};
+    std::atomic<double> sampleRate{44100.0};
+    SimpleMBComp::Fifo<juce::AudioBuffer<float>> chunks;
+
+    // Audio thread
+    std::vector<float> inputMix;
+    juce::AudioBuffer<float> chunk;
+    int chunkPosition = 0;
+
+    // Analysis thread
+    juce::dsp::FFT fft{fftOrder};
+    juce::dsp::WindowingFunction<float> window{static_cast<size_t>(fftSize), juce::dsp::WindowingFunction<float>::hann, false};
+    std::array<float, 2 * fftSize> fftData{};
+    std::array<std::array<float, fftSize>, numTraces> history{};
+    std::array<std::array<float, fftSize / 2 + 1>, numTraces> levels{};
+    size_t historyPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
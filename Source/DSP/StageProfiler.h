@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    Per-stage CPU timing for the processing chain.
+
+    The audio thread brackets each stage with high resolution tick reads and
+    folds the results into a window of blocks; once a window covers
+    publishIntervalSeconds of audio, endBlock() hands out a Snapshot for the
+    processor to push through a lock-free FIFO to the editor.
+
+    Stages time into a StageTicks of their own, so channel groups running
+    on worker threads never share one; the audio thread folds them in with
+    addStageTicks() after the join. Stage times are therefore CPU time
+    summed over the groups, and with workers they can add up to more than
+    the block, which is wall time.
+
+    The instrumentation is compiled into debug builds only; define
+    AUDIO_PLUGIN_PROFILING=1 to profile a release build, or =0 to leave it
+    out of a debug one.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef AUDIO_PLUGIN_PROFILING
+ #if JUCE_DEBUG
+  #define AUDIO_PLUGIN_PROFILING 1
+ #else
+  #define AUDIO_PLUGIN_PROFILING 0
+ #endif
+#endif
+
+template <size_t NumStages>
+struct StageProfiler
+{
+    using StageTicks = std::array<juce::int64, NumStages>;
+
+    struct Snapshot
+    {
+        std::array<double, NumStages> stageAverageMs{}; // per block, summed over the block's sub-blocks and channel groups
+        std::array<double, NumStages> stageWorstMs{};
+        double blockAverageMs = 0.0; // the whole processBlock
+        double blockWorstMs = 0.0;
+        double deadlineMs = 0.0;         // duration of an average block at the current sample rate
+        double averageLoadPercent = 0.0; // processing time over audio time
+        double worstLoadPercent = 0.0;   // worst single block against its own deadline
+        int numBlocks = 0;
+    };
+
+    // Times one stage into ticks for as long as it is in scope
+    struct ScopedStage
+    {
+        ScopedStage(StageTicks &ticksToUse, size_t stageToTime) noexcept
+            : ticks(ticksToUse), stage(stageToTime), start(now())
+        {
+        }
+
+        ~ScopedStage() { ticks[stage] += now() - start; }
+
+        StageTicks &ticks;
+        const size_t stage;
+        const juce::int64 start;
+    };
+
+    static juce::int64 now() noexcept { return juce::Time::getHighResolutionTicks(); }
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        ticksPerSecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+        publishIntervalSamples = juce::roundToInt(sampleRate * publishIntervalSeconds);
+        clearWindow();
+    }
+
+    void beginBlock() noexcept
+    {
+        stageTicks.fill(0);
+        blockStart = now();
+    }
+
+    // Adds a group's stage times to the current block and clears them for the next sub-block. Audio thread.
+    void addStageTicks(StageTicks &groupTicks) noexcept
+    {
+        for (size_t i = 0; i < NumStages; ++i)
+            stageTicks[i] += groupTicks[i];
+
+        groupTicks.fill(0);
+    }
+
+    // Folds the finished block into the window. Returns true (with the window in ready) once it is due for publishing.
+    bool endBlock(int numSamples, Snapshot &ready) noexcept
+    {
+        const auto blockTicks = now() - blockStart;
+
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return false;
+
+        for (size_t i = 0; i < NumStages; ++i)
+        {
+            windowStageTicks[i] += stageTicks[i];
+            windowStageWorst[i] = juce::jmax(windowStageWorst[i], stageTicks[i]);
+        }
+
+        windowBlockTicks += blockTicks;
+        windowBlockWorst = juce::jmax(windowBlockWorst, blockTicks);
+
+        const auto deadlineTicks = static_cast<double>(numSamples) / sampleRate * ticksPerSecond;
+        windowWorstLoad = juce::jmax(windowWorstLoad, static_cast<double>(blockTicks) / deadlineTicks);
+
+        windowSamples += numSamples;
+        ++windowBlocks;
+
+        if (windowSamples < publishIntervalSamples)
+            return false;
+
+        const auto msPerTick = 1000.0 / ticksPerSecond;
+        const auto blocks = static_cast<double>(windowBlocks);
+
+        for (size_t i = 0; i < NumStages; ++i)
+        {
+            ready.stageAverageMs[i] = static_cast<double>(windowStageTicks[i]) * msPerTick / blocks;
+            ready.stageWorstMs[i] = static_cast<double>(windowStageWorst[i]) * msPerTick;
+        }
+
+        ready.blockAverageMs = static_cast<double>(windowBlockTicks) * msPerTick / blocks;
+        ready.blockWorstMs = static_cast<double>(windowBlockWorst) * msPerTick;
+        ready.deadlineMs = static_cast<double>(windowSamples) / sampleRate * 1000.0 / blocks;
+        ready.averageLoadPercent = ready.blockAverageMs / ready.deadlineMs * 100.0;
+        ready.worstLoadPercent = windowWorstLoad * 100.0;
+        ready.numBlocks = windowBlocks;
+
+        clearWindow();
+        return true;
+    }
+
+private:
+    static constexpr double publishIntervalSeconds = 0.1;
+
+    void clearWindow() noexcept
+    {
+        windowStageTicks.fill(0);
+        windowStageWorst.fill(0);
+        windowBlockTicks = 0;
+        windowBlockWorst = 0;
+        windowWorstLoad = 0.0;
+        windowSamples = 0;
+        windowBlocks = 0;
+    }
+
+    double sampleRate = 0.0;
+    double ticksPerSecond = 1.0;
+    int publishIntervalSamples = 0;
+
+    juce::int64 blockStart = 0;
+    StageTicks stageTicks{};
+
+    StageTicks windowStageTicks{};
+    StageTicks windowStageWorst{};
+    juce::int64 windowBlockTicks = 0;
+    juce::int64 windowBlockWorst = 0;
+    double windowWorstLoad = 0.0;
+    int windowSamples = 0;
+    int windowBlocks = 0;
+};
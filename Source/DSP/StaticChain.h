@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    A processing chain over a fixed set of module types, one instance of
+    each, run in a runtime order without virtual calls.
+
+    Every order that uses each module at most once (all the permutations
+    of every subset of the pack, from the empty chain up) is enumerated at
+    compile time, and each gets its own specialisation of process() with
+    the modules called by their concrete types, so the compiler can inline
+    them into one function. getProcessFunction() looks an order up in that
+    table once, when a chain is built; processing is then one indirect call
+    per block. Orders that repeat a module are not in the table and need a
+    per-slot fallback.
+
+    Bypass comes in as a mask with one bit per module index, worked out
+    once per block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace StaticChainOrders
+{
+// Module indices in processing order; slots from length on are unused
+template <size_t NumModules>
+struct Order
+{
+    std::array<int, NumModules> slots{};
+    size_t length = 0;
+};
+
+// Sum over the lengths k of NumModules! / (NumModules - k)!
+template <size_t NumModules>
+constexpr size_t count() noexcept
+{
+    size_t total = 0, arrangements = 1;
+
+    for (size_t k = 0; k <= NumModules; ++k)
+    {
+        total += arrangements;
+        arrangements *= NumModules - k;
+    }
+
+    return total;
+}
+
+// Every order with no module repeated, shortest first
+template <size_t NumModules>
+constexpr std::array<Order<NumModules>, count<NumModules>()> enumerate() noexcept
+{
+    std::array<Order<NumModules>, count<NumModules>()> result{};
+    size_t next = 0;
+
+    for (size_t length = 0; length <= NumModules; ++length)
+    {
+        // Every length-digit number in base NumModules, keeping those with no digit repeated
+        size_t combinations = 1;
+
+        for (size_t k = 0; k < length; ++k)
+            combinations *= NumModules;
+
+        for (size_t code = 0; code < combinations; ++code)
+        {
+            Order<NumModules> order;
+            order.length = length;
+            unsigned int used = 0;
+            auto valid = true;
+            auto remainder = code;
+
+            for (size_t slot = length; slot-- > 0;)
+            {
+                const auto module = remainder % NumModules;
+                remainder /= NumModules;
+
+                valid = valid && (used & (1u << module)) == 0;
+                used |= 1u << module;
+                order.slots[slot] = static_cast<int>(module);
+            }
+
+            if (valid)
+                result[next++] = order;
+        }
+    }
+
+    return result;
+}
+} // namespace StaticChainOrders
+
+template <typename... Modules>
+struct StaticChain
+{
+    static constexpr size_t numModules = sizeof...(Modules);
+    static_assert(numModules > 0 && numModules <= 8, "orders are enumerated exhaustively, keep the module set small");
+
+    using Context = juce::dsp::ProcessContextReplacing<float>;
+    using ProcessFunction = void (*)(StaticChain &, Context &, juce::uint32 bypassMask);
+
+    // The specialisation for an order given as module indices, or nullptr when it repeats a module
+    static ProcessFunction getProcessFunction(const int *moduleIndices, size_t length) noexcept
+    {
+        static constexpr auto processFunctions = makeProcessFunctions(std::make_index_sequence<orders.size()>{});
+
+        if (length > numModules)
+            return nullptr;
+
+        for (size_t i = 0; i < orders.size(); ++i)
+        {
+            if (orders[i].length == length && std::equal(moduleIndices, moduleIndices + length, orders[i].slots.begin()))
+                return processFunctions[i];
+        }
+
+        return nullptr;
+    }
+
+    // The instance of a module, by index, as a pointer to a common base
+    template <typename Base>
+    Base *getModule(size_t index) noexcept
+    {
+        return getModule<Base>(index, std::index_sequence_for<Modules...>{});
+    }
+
+    std::tuple<Modules...> modules;
+
+private:
+    static constexpr auto orders = StaticChainOrders::enumerate<numModules>();
+
+    template <size_t OrderIndex, size_t Slot>
+    static void processSlot(StaticChain &chain, Context &context, juce::uint32 bypassMask) noexcept
+    {
+        if constexpr (Slot < orders[OrderIndex].length)
+        {
+            constexpr auto module = static_cast<size_t>(orders[OrderIndex].slots[Slot]);
+
+            context.isBypassed = (bypassMask & (1u << module)) != 0;
+            std::get<module>(chain.modules).process(context);
+        }
+    }
+
+    template <size_t OrderIndex, size_t... Slots>
+    static void processOrder(StaticChain &chain, Context &context, juce::uint32 bypassMask, std::index_sequence<Slots...>) noexcept
+    {
+        (processSlot<OrderIndex, Slots>(chain, context, bypassMask), ...);
+    }
+
+    template <size_t OrderIndex>
+    static void processOrder(StaticChain &chain, Context &context, juce::uint32 bypassMask) noexcept
+    {
+        processOrder<OrderIndex>(chain, context, bypassMask, std::make_index_sequence<numModules>{});
+    }
+
+    template <size_t... OrderIndices>
+    static constexpr std::array<ProcessFunction, sizeof...(OrderIndices)> makeProcessFunctions(std::index_sequence<OrderIndices...>) noexcept
+    {
+        return {&processOrder<OrderIndices>...};
+    }
+
+    template <typename Base, size_t... Indices>
+    Base *getModule(size_t index, std::index_sequence<Indices...>) noexcept
+    {
+        Base *module = nullptr;
+        ((module = Indices == index ? static_cast<Base *>(&std::get<Indices>(modules)) : module), ...);
+        return module;
+    }
+};
@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    Phaser for the Phase stage: a cascade of 4 to 12 first-order allpass
+    stages swept by a sine LFO, with feedback around the cascade and a
+    dry/wet mix. The controls follow juce::dsp::Phaser, whose place it takes.
+
+    Channels are packed into the lanes of a juce::dsp::SIMDRegister, as in
+    MultiChannelBiquad, so the whole cascade runs once per sample for a
+    group of channels. Odd channels (the right of each pair) can run the
+    LFO ahead of even ones for a wider stereo sweep (setStereoOffset). With
+    no offset every channel sweeps together, as juce::dsp::Phaser does.
+
+    The allpass coefficient is computed exactly every controlInterval
+    samples and interpolated linearly in between, so the sweep is smooth
+    per sample without a tan() per sample. Feedback and mix ramp across
+    each block from their previous values.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct StereoPhaser
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr size_t lanes = SIMDFloat::size();
+
+    static constexpr int minStages = 4;
+    static constexpr int maxStages = 12;
+    static constexpr int defaultStages = 6;
+    static constexpr size_t controlInterval = 8;
+    static constexpr double maxStereoOffset = 0.5; // of an LFO cycle, between even and odd channels
+    static constexpr float maxFeedback = 0.99f;      // keeps the loop strictly stable
+    static constexpr float minFrequency = 20.0f;
+
+    static_assert(lanes % 2 == 0, "lane parity must match channel parity");
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        sampleRate = spec.sampleRate;
+        numChannels = spec.numChannels;
+        numGroups = (numChannels + lanes - 1) / lanes;
+        maxFrequency = static_cast<float>(juce::jmin(20000.0, 0.49 * sampleRate));
+
+        groups.resize(numGroups);
+        interleaved.resize(spec.maximumBlockSize);
+        feedbackRamp.resize(spec.maximumBlockSize);
+        mixRamp.resize(spec.maximumBlockSize);
+        controlPoints.resize(spec.maximumBlockSize / controlInterval + 2);
+
+        updateSweep();
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto &group : groups)
+        {
+            group.stages.fill(SIMDFloat::expand(0.0f));
+            group.lastOutput = SIMDFloat::expand(0.0f);
+        }
+
+        lfoPhase = 0.0;
+        currentCoefficients = computeCoefficients(lfoPhase);
+        currentFeedback = feedback;
+        currentMix = mix;
+    }
+
+    void setRate(float newRateHz) noexcept { rateHz = newRateHz; }
+
+    // 0 to 1
+    void setDepth(float newDepth) noexcept
+    {
+        depth = juce::jlimit(0.0f, 1.0f, newDepth);
+        updateSweep();
+    }
+
+    void setCentreFrequency(float newCentreHz) noexcept
+    {
+        centreHz = newCentreHz;
+        updateSweep();
+    }
+
+    // -1 to 1
+    void setFeedback(float newFeedback) noexcept { feedback = juce::jlimit(-maxFeedback, maxFeedback, newFeedback); }
+
+    // 0 (dry) to 1 (wet)
+    void setMix(float newMix) noexcept { mix = juce::jlimit(0.0f, 1.0f, newMix); }
+
+    void setNumStages(int newNumStages) noexcept { numStages = juce::jlimit(minStages, maxStages, newNumStages); }
+
+    // How far odd channels run ahead of even ones, in LFO cycles (0 to maxStereoOffset)
+    void setStereoOffset(double newOffset) noexcept { stereoOffset = juce::jlimit(0.0, maxStereoOffset, newOffset); }
+    int getNumStages() const noexcept { return numStages; }
+
+    // The bottom of the sweep, where the cascade rings the longest
+    float getLowestFrequency() const noexcept
+    {
+        return minFrequency * std::pow(maxFrequency / minFrequency, juce::jmax(0.0f, normalisedCentre - sweepDepth));
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        auto &&outputBlock = context.getOutputBlock();
+        const auto numSamples = outputBlock.getNumSamples();
+        const auto blockChannels = juce::jmin(outputBlock.getNumChannels(), static_cast<size_t>(numChannels));
+
+        jassert(numSamples <= interleaved.size());
+
+        if (context.isBypassed || numSamples == 0)
+            return;
+
+        // The LFO, feedback and mix are the same for every group, so they are worked out once per block
+        const auto numSegments = prepareControl(numSamples);
+        auto *lanesData = reinterpret_cast<float *>(interleaved.data());
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            const auto firstChannel = group * lanes;
+
+            if (firstChannel >= blockChannels)
+                break;
+
+            const auto groupChannels = juce::jmin(lanes, blockChannels - firstChannel);
+
+            // Interleave this group's channels into SIMD lanes (unused lanes stay silent)
+            if (groupChannels < lanes)
+                std::fill(lanesData, lanesData + numSamples * lanes, 0.0f);
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                const auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    lanesData[i * lanes + lane] = channel[i];
+            }
+
+            processInterleaved(groups[group], numSamples, numSegments);
+
+            // out = dry + (wet - dry) * mix
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    channel[i] += (lanesData[i * lanes + lane] - channel[i]) * mixRamp[i];
+            }
+        }
+
+        currentCoefficients = controlPoints[numSegments];
+        currentFeedback = feedback;
+        currentMix = mix;
+    }
+
+private:
+    struct Group
+    {
+        std::array<SIMDFloat, maxStages> stages;
+        SIMDFloat lastOutput;
+    };
+
+    // Maps the centre and depth onto the same logarithmic sweep as juce::dsp::Phaser
+    void updateSweep() noexcept
+    {
+        const auto centre = juce::jlimit(minFrequency, maxFrequency, centreHz);
+        normalisedCentre = std::log(centre / minFrequency) / std::log(maxFrequency / minFrequency);
+        sweepDepth = depth * 0.5f;
+    }
+
+    // Allpass coefficients for every lane at the given LFO phase (in cycles)
+    SIMDFloat computeCoefficients(double phase) const noexcept
+    {
+        const auto even = computeCoefficient(phase);
+        const auto odd = computeCoefficient(phase + stereoOffset);
+
+        SIMDFloat coefficients;
+
+        for (size_t lane = 0; lane < lanes; ++lane)
+            coefficients.set(lane, lane % 2 == 0 ? even : odd);
+
+        return coefficients;
+    }
+
+    float computeCoefficient(double phase) const noexcept
+    {
+        const auto lfo = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * phase));
+        const auto position = juce::jlimit(0.0f, 1.0f, normalisedCentre + sweepDepth * lfo);
+        const auto frequency = minFrequency * std::pow(maxFrequency / minFrequency, position);
+        const auto t = std::tan(juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate));
+
+        return (t - 1.0f) / (t + 1.0f);
+    }
+
+    // Fills the control points and the feedback and mix ramps for the block, and advances the LFO.
+    // Returns the number of control segments.
+    size_t prepareControl(size_t numSamples) noexcept
+    {
+        const auto numSegments = (numSamples + controlInterval - 1) / controlInterval;
+        const auto phaseIncrement = static_cast<double>(rateHz) / sampleRate;
+
+        controlPoints[0] = currentCoefficients;
+
+        for (size_t k = 1; k <= numSegments; ++k)
+        {
+            const auto position = juce::jmin(k * controlInterval, numSamples);
+            controlPoints[k] = computeCoefficients(lfoPhase + phaseIncrement * static_cast<double>(position));
+        }
+
+        lfoPhase += phaseIncrement * static_cast<double>(numSamples);
+        lfoPhase -= std::floor(lfoPhase);
+
+        const auto feedbackStep = (feedback - currentFeedback) / static_cast<float>(numSamples);
+        const auto mixStep = (mix - currentMix) / static_cast<float>(numSamples);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            feedbackRamp[i] = currentFeedback + feedbackStep * static_cast<float>(i + 1);
+            mixRamp[i] = currentMix + mixStep * static_cast<float>(i + 1);
+        }
+
+        return numSegments;
+    }
+
+    void processInterleaved(Group &group, size_t numSamples, size_t numSegments) noexcept
+    {
+        auto stages = group.stages;
+        auto lastOutput = group.lastOutput;
+        size_t i = 0;
+
+        for (size_t k = 0; k < numSegments; ++k)
+        {
+            const auto end = juce::jmin(i + controlInterval, numSamples);
+            auto coefficient = controlPoints[k];
+            const auto step = (controlPoints[k + 1] - coefficient) * (1.0f / static_cast<float>(end - i));
+
+            for (; i < end; ++i)
+            {
+                coefficient += step;
+
+                // The feedback is subtracted from the input, as in juce::dsp::Phaser
+                auto x = interleaved[i] - lastOutput * feedbackRamp[i];
+
+                // Transposed direct form II: y = a x + s, s = x - a y
+                for (int n = 0; n < numStages; ++n)
+                {
+                    auto &s = stages[static_cast<size_t>(n)];
+                    const auto y = coefficient * x + s;
+                    s = x - coefficient * y;
+                    x = y;
+                }
+
+                lastOutput = x;
+                interleaved[i] = x;
+            }
+        }
+
+        group.stages = stages;
+        group.lastOutput = lastOutput;
+    }
+
+    double sampleRate = 44100.0;
+    float maxFrequency = 20000.0f;
+
+    float rateHz = 1.0f;
+    float depth = 0.5f;
+    float centreHz = 1000.0f;
+    float feedback = 0.0f;
+    float mix = 0.5f;
+    int numStages = defaultStages;
+    double stereoOffset = 0.0;
+
+    float normalisedCentre = 0.5f;
+    float sweepDepth = 0.25f;
+
+    double lfoPhase = 0.0;
+    SIMDFloat currentCoefficients = SIMDFloat::expand(0.0f);
+    float currentFeedback = 0.0f;
+    float currentMix = 0.5f;
+
+    size_t numChannels = 0;
+    size_t numGroups = 0;
+    std::vector<Group> groups;
+    std::vector<SIMDFloat> interleaved;
+    std::vector<SIMDFloat> controlPoints;
+    std::vector<float> feedbackRamp;
+    std::vector<float> mixRamp;
+};
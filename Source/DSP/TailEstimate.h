@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    Rough tail lengths (time for a stage's output to fall 60 dB after its
+    input stops) at the current settings.
+
+    These are estimates for getTailLengthSeconds() and the silence sleep:
+    they err long rather than short, and every result is capped at
+    maxSeconds so a self-oscillating setting does not keep an instance
+    awake (or an offline render running) for ever.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCoefficients.h"
+
+struct TailEstimate
+{
+    static constexpr double maxSeconds = 10.0;
+
+    // ln(1000): a decay of 60 dB, in time constants
+    static constexpr double decayTimeConstants = 6.907755;
+
+    // Time for a signal fed back around a loop of loopSeconds with the given gain to decay
+    static double recirculation(double loopSeconds, double feedback) noexcept
+    {
+        const auto gain = std::abs(feedback);
+
+        if (gain <= 0.0)
+            return 0.0;
+
+        if (gain >= 1.0)
+            return maxSeconds;
+
+        return cap(loopSeconds * decayTimeConstants / -std::log(gain));
+    }
+
+    // StereoPhaser: first-order allpass stages in a feedback loop. The lowest cutoff of the LFO's
+    // sweep rings the longest.
+    static double phaser(double lowestHz, int numStages, double feedback) noexcept
+    {
+        const auto stages = static_cast<double>(numStages);
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(20.0, lowestHz);
+        const auto stageDecay = decayTimeConstants / omega;
+        const auto loopSeconds = stages * 2.0 / omega; // DC group delay of the allpass cascade
+
+        return cap(stages * stageDecay + recirculation(loopSeconds, feedback));
+    }
+
+    // MultiVoiceChorus: a modulated delay line, fed back through the average of its voices, so the
+    // longest delay any voice reaches sets the loop time
+    static double chorus(double longestDelayMs, double feedback) noexcept
+    {
+        const auto longestDelay = longestDelayMs * 0.001;
+        return cap(longestDelay + recirculation(longestDelay, feedback));
+    }
+
+    // TieredLadderFilter: four one-pole lowpasses whose loop gain at cutoff is the
+    // (rescaled) resonance, so the ringing grows as 1 / (1 - resonance)
+    static double ladder(double cutoffHz, double resonance) noexcept
+    {
+        const auto loopGain = juce::jmap(juce::jlimit(0.0, 1.0, resonance), 0.1, 1.0);
+
+        if (loopGain >= 1.0)
+            return maxSeconds;
+
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(20.0, cutoffHz);
+        return cap(4.0 * decayTimeConstants / omega / (1.0 - loopGain));
+    }
+
+    // Exact for a biquad: the decay of its slowest pole
+    static double biquad(const BiquadCoefficients &coefficients, double sampleRate) noexcept
+    {
+        const auto a1 = static_cast<double>(coefficients.raw[3]);
+        const auto a2 = static_cast<double>(coefficients.raw[4]);
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+
+        // Poles of z^2 + a1 z + a2
+        const auto radius = discriminant < 0.0 ? std::sqrt(a2)
+                                               : juce::jmax(std::abs(-a1 + std::sqrt(discriminant)), std::abs(-a1 - std::sqrt(discriminant))) * 0.5;
+
+        if (radius <= 0.0)
+            return 2.0 / sampleRate; // FIR: the two sample delay line
+
+        if (radius >= 1.0)
+            return maxSeconds;
+
+        return cap(decayTimeConstants / -std::log(radius) / sampleRate);
+    }
+
+private:
+    static double cap(double seconds) noexcept { return juce::jlimit(0.0, maxSeconds, seconds); }
+};
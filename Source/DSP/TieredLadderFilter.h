@@ -0,0 +1,360 @@
+/*
+  ==============================================================================
+
+    Ladder filter for the Ladder Filter stage: the topology, modes and
+    controls of juce::dsp::LadderFilter (four one-pole lowpasses with
+    saturated input and resonance feedback), in three quality tiers.
+
+      Eco     polynomial saturation; the pole coefficient ramps linearly
+              between exact values at the ends of each block
+      Normal  table tanh (SaturationCurves::TanhTable); the cutoff sweeps
+              exponentially and is warped to the pole coefficient by a
+              lookup table every sample
+      HQ      exact tanh and an exact pole coefficient every sample
+
+    Cutoff and resonance ramp per sample from their previous values to the
+    ones set for the block, so a control-rate sweep (smoothing, automation,
+    the modulation matrix) is glided rather than stepped, without a
+    transcendental per sample below HQ. Drive is set per block.
+
+    Channels are packed into the lanes of a juce::dsp::SIMDRegister, as in
+    StereoPhaser, so the whole ladder runs once per sample for a group of
+    channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Saturator.h"
+
+struct TieredLadderFilter
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    using Mode = juce::dsp::LadderFilterMode;
+    static constexpr size_t lanes = SIMDFloat::size();
+
+    enum class Quality
+    {
+        Eco,
+        Normal,
+        HQ,
+        END_OF_LIST
+    };
+
+    void prepare(const juce::dsp::ProcessSpec &spec)
+    {
+        getCutoffTable(); // build the tables off the audio thread
+        SaturationCurves::TanhTable::getTable();
+
+        sampleRate = spec.sampleRate;
+        numChannels = spec.numChannels;
+        numGroups = (numChannels + lanes - 1) / lanes;
+
+        groups.resize(numGroups);
+        interleaved.resize(spec.maximumBlockSize);
+        coefficientRamp.resize(spec.maximumBlockSize);
+        resonanceRamp.resize(spec.maximumBlockSize);
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto &group : groups)
+            group.state.fill(SIMDFloat::expand(0.0f));
+
+        currentLogCutoff = getLogCutoff();
+        currentResonance = getScaledResonance();
+    }
+
+    void setCutoffFrequencyHz(float newCutoffHz) noexcept { cutoffHz = newCutoffHz; }
+
+    // 0 to 1, self-oscillating at 1
+    void setResonance(float newResonance) noexcept { resonance = juce::jlimit(0.0f, 1.0f, newResonance); }
+
+    // 1 and up, with the same input and feedback gain compensation as juce::dsp::LadderFilter
+    void setDrive(float newDrive) noexcept
+    {
+        drive = juce::jmax(1.0f, newDrive);
+        inputGain = std::pow(drive, -2.642f) * 0.6103f + 0.3903f;
+        feedbackDrive = drive * 0.04f + 0.96f;
+        feedbackGain = std::pow(feedbackDrive, -2.642f) * 0.6103f + 0.3903f;
+    }
+
+    void setMode(Mode newMode) noexcept
+    {
+        switch (newMode)
+        {
+        case Mode::LPF12: outputMix = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f}; compensation = 0.5f; break;
+        case Mode::HPF12: outputMix = {1.0f, -2.0f, 1.0f, 0.0f, 0.0f}; compensation = 0.0f; break;
+        case Mode::BPF12: outputMix = {0.0f, 0.0f, -1.0f, 1.0f, 0.0f}; compensation = 0.5f; break;
+        case Mode::LPF24: outputMix = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f}; compensation = 0.5f; break;
+        case Mode::HPF24: outputMix = {1.0f, -4.0f, 6.0f, -4.0f, 1.0f}; compensation = 0.0f; break;
+        case Mode::BPF24: outputMix = {0.0f, 0.0f, 1.0f, -2.0f, 1.0f}; compensation = 0.5f; break;
+        default: break;
+        }
+    }
+
+    void setQuality(Quality newQuality) noexcept { quality = newQuality; }
+    Quality getQuality() const noexcept { return quality; }
+
+    // Complex response at the current settings with the saturation linearised (its slope at 0 is 1 in every
+    // tier), i.e. what the filter does to a quiet signal, running at processingRate. Louder signals are
+    // compressed by the saturation, which mostly tames the resonance.
+    std::complex<double> getSmallSignalResponse(double frequencyHz, double processingRate) const noexcept
+    {
+        const auto normalisedCutoff = juce::jlimit(std::exp2(static_cast<double>(minOctave)), static_cast<double>(maxNormalisedCutoff),
+                                                   static_cast<double>(cutoffHz) / processingRate);
+        const auto a = std::exp(-juce::MathConstants<double>::twoPi * normalisedCutoff);
+        const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencyHz / processingRate); // z^-1
+
+        // One pole: y = (1 - a)(0.769 x + 0.231 x[n-1]) + a y[n-1]
+        const auto pole = (1.0 - a) * (0.76923076923 + 0.23076923076 * z) / (1.0 - a * z);
+        const auto r = static_cast<double>(getScaledResonance());
+
+        // y0 = dx (1 + 4 r c) - 4 r F y4[n-1], with y4 = pole^4 y0
+        const auto dx = static_cast<double>(drive * inputGain) * (1.0 + 4.0 * r * static_cast<double>(compensation));
+        const auto loop = 4.0 * r * static_cast<double>(feedbackDrive * feedbackGain) * z * std::pow(pole, 4);
+
+        std::complex<double> mix = 0.0, poles = 1.0;
+
+        for (auto weight : outputMix)
+        {
+            mix += static_cast<double>(weight) * poles;
+            poles *= pole;
+        }
+
+        return dx * mix / (1.0 + loop);
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<float> &context) noexcept
+    {
+        auto &&outputBlock = context.getOutputBlock();
+        const auto numSamples = outputBlock.getNumSamples();
+        const auto blockChannels = juce::jmin(outputBlock.getNumChannels(), static_cast<size_t>(numChannels));
+
+        jassert(numSamples <= interleaved.size());
+
+        if (context.isBypassed || numSamples == 0)
+            return;
+
+        // The ramps are the same for every group, so they are worked out once per block
+        prepareRamps(numSamples);
+        auto *lanesData = reinterpret_cast<float *>(interleaved.data());
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            const auto firstChannel = group * lanes;
+
+            if (firstChannel >= blockChannels)
+                break;
+
+            const auto groupChannels = juce::jmin(lanes, blockChannels - firstChannel);
+
+            // Interleave this group's channels into SIMD lanes (unused lanes stay silent)
+            if (groupChannels < lanes)
+                std::fill(lanesData, lanesData + numSamples * lanes, 0.0f);
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                const auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    lanesData[i * lanes + lane] = channel[i];
+            }
+
+            switch (quality)
+            {
+            case Quality::Eco:
+                processInterleaved<PolynomialSaturation>(groups[group], numSamples);
+                break;
+            case Quality::HQ:
+                processInterleaved<SaturationCurves::Tanh>(groups[group], numSamples);
+                break;
+            default:
+                processInterleaved<SaturationCurves::TanhTable>(groups[group], numSamples);
+                break;
+            }
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                auto *channel = outputBlock.getChannelPointer(firstChannel + lane);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    channel[i] = lanesData[i * lanes + lane];
+            }
+        }
+
+        currentLogCutoff = getLogCutoff();
+        currentResonance = getScaledResonance();
+    }
+
+private:
+    // The cutoff table covers normalised cutoffs (cycles per sample) from 2^minOctave to 2^maxOctave
+    static constexpr float minOctave = -16.0f;
+    static constexpr float maxOctave = -1.0f;
+    static constexpr int cutoffTableSize = 1024;
+    static constexpr float maxNormalisedCutoff = 0.49f;
+
+    // x - 4x^3 / 27 on [-1.5, 1.5]: tanh's slope at 0, flat where it reaches +-1
+    struct PolynomialSaturation
+    {
+        static SIMDFloat apply(SIMDFloat x) noexcept
+        {
+            return SaturationCurves::SoftClip::apply(x * (1.0f / 1.5f));
+        }
+    };
+
+    struct Group
+    {
+        std::array<SIMDFloat, 5> state; // the feedback input, then the four pole outputs
+    };
+
+    // Pole coefficient exp(-2 pi f) for a normalised cutoff f
+    static float getCoefficient(float normalisedCutoff) noexcept
+    {
+        return std::exp(-juce::MathConstants<float>::twoPi * normalisedCutoff);
+    }
+
+    // Pole coefficient against log2 of the normalised cutoff, shared by every instance and sample rate
+    static const std::array<float, cutoffTableSize + 1> &getCutoffTable()
+    {
+        static const auto table = []
+        {
+            std::array<float, cutoffTableSize + 1> t{};
+
+            for (int i = 0; i <= cutoffTableSize; ++i)
+            {
+                const auto octave = minOctave + (maxOctave - minOctave) * static_cast<float>(i) / static_cast<float>(cutoffTableSize);
+                t[static_cast<size_t>(i)] = getCoefficient(std::exp2(octave));
+            }
+
+            return t;
+        }();
+
+        return table;
+    }
+
+    static float lookUpCoefficient(float logCutoff) noexcept
+    {
+        constexpr auto scale = static_cast<float>(cutoffTableSize) / (maxOctave - minOctave);
+        const auto &table = getCutoffTable();
+
+        const auto position = (juce::jlimit(minOctave, maxOctave, logCutoff) - minOctave) * scale;
+        const auto index = juce::jmin(static_cast<int>(position), cutoffTableSize - 1);
+        const auto fraction = position - static_cast<float>(index);
+        const auto c0 = table[static_cast<size_t>(index)];
+
+        return c0 + fraction * (table[static_cast<size_t>(index) + 1] - c0);
+    }
+
+    // log2 of the normalised cutoff, the domain the cutoff sweeps in
+    float getLogCutoff() const noexcept
+    {
+        const auto normalised = juce::jlimit(std::exp2(minOctave), maxNormalisedCutoff, cutoffHz / static_cast<float>(sampleRate));
+        return std::log2(normalised);
+    }
+
+    float getScaledResonance() const noexcept { return juce::jmap(resonance, 0.1f, 1.0f); }
+
+    void prepareRamps(size_t numSamples) noexcept
+    {
+        const auto targetLogCutoff = getLogCutoff();
+        const auto targetResonance = getScaledResonance();
+        const auto inverseSamples = 1.0f / static_cast<float>(numSamples);
+        const auto resonanceStep = (targetResonance - currentResonance) * inverseSamples;
+
+        for (size_t i = 0; i < numSamples; ++i)
+            resonanceRamp[i] = currentResonance + resonanceStep * static_cast<float>(i + 1);
+
+        switch (quality)
+        {
+        case Quality::Eco:
+        {
+            const auto start = getCoefficient(std::exp2(currentLogCutoff));
+            const auto step = (getCoefficient(std::exp2(targetLogCutoff)) - start) * inverseSamples;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                coefficientRamp[i] = start + step * static_cast<float>(i + 1);
+
+            break;
+        }
+        case Quality::HQ:
+        {
+            const auto step = (targetLogCutoff - currentLogCutoff) * inverseSamples;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                coefficientRamp[i] = getCoefficient(std::exp2(currentLogCutoff + step * static_cast<float>(i + 1)));
+
+            break;
+        }
+        default:
+        {
+            const auto step = (targetLogCutoff - currentLogCutoff) * inverseSamples;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                coefficientRamp[i] = lookUpCoefficient(currentLogCutoff + step * static_cast<float>(i + 1));
+
+            break;
+        }
+        }
+    }
+
+    template <typename Saturation>
+    void processInterleaved(Group &group, size_t numSamples) noexcept
+    {
+        auto s = group.state;
+
+        const auto inputDrive = SIMDFloat::expand(drive);
+        const auto loopDrive = SIMDFloat::expand(feedbackDrive);
+        const auto [a0, a1, a2, a3, a4] = outputMix;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            // Each pole is y = b0 x + b1 x[n-1] + a y[n-1], a zero at -0.3 on the one-pole lowpass, as in juce::dsp::LadderFilter
+            const auto a = coefficientRamp[i];
+            const auto g = 1.0f - a;
+            const auto b0 = g * 0.76923076923f;
+            const auto b1 = g * 0.23076923076f;
+
+            const auto dx = Saturation::apply(inputDrive * interleaved[i]) * inputGain;
+            const auto feedback = Saturation::apply(loopDrive * s[4]) * feedbackGain - dx * compensation;
+            const auto y0 = dx + feedback * (resonanceRamp[i] * -4.0f);
+
+            const auto y1 = s[0] * b1 + s[1] * a + y0 * b0;
+            const auto y2 = s[1] * b1 + s[2] * a + y1 * b0;
+            const auto y3 = s[2] * b1 + s[3] * a + y2 * b0;
+            const auto y4 = s[3] * b1 + s[4] * a + y3 * b0;
+
+            s = {y0, y1, y2, y3, y4};
+
+            interleaved[i] = y0 * a0 + y1 * a1 + y2 * a2 + y3 * a3 + y4 * a4;
+        }
+
+        group.state = s;
+    }
+
+    double sampleRate = 44100.0;
+
+    float cutoffHz = 200.0f;
+    float resonance = 0.0f;
+    float drive = 1.0f;
+    float inputGain = 0.6103f + 0.3903f; // as set by setDrive(1)
+    float feedbackDrive = 1.0f;
+    float feedbackGain = 0.6103f + 0.3903f;
+    std::array<float, 5> outputMix{0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+    float compensation = 0.5f;
+    Quality quality = Quality::Normal;
+
+    float currentLogCutoff = 0.0f;
+    float currentResonance = 0.1f;
+
+    size_t numChannels = 0;
+    size_t numGroups = 0;
+    std::vector<Group> groups;
+    std::vector<SIMDFloat> interleaved;
+    std::vector<float> coefficientRamp;
+    std::vector<float> resonanceRamp;
+};
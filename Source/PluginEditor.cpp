@@ -9,13 +9,207 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay(AudioPluginAudioProcessor &p)
+    : audioProcessor(p)
+{
+  setOpaque(true);
+  audioProcessor.spectrumAnalyzer.addClient();
+  startTimerHz(SpectrumAnalyzer::frameRateHz);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+  stopTimer();
+  audioProcessor.spectrumAnalyzer.removeClient();
+}
+
+void SpectrumDisplay::timerCallback()
+{
+  const auto latestVersion = audioProcessor.spectrumAnalyzer.getPaths(pathVersion, prePath, postPath);
+
+  if (latestVersion != pathVersion)
+  {
+    pathVersion = latestVersion;
+    repaint();
+  }
+}
+
+void SpectrumDisplay::paint(juce::Graphics &g)
+{
+  g.fillAll(juce::Colours::black);
+
+  const auto bounds = getLocalBounds().toFloat().reduced(1.0f);
+  const auto toBounds = juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getX(), bounds.getY());
+
+  // Grid: decades of frequency and every 24 dB
+  g.setColour(juce::Colours::white.withAlpha(0.15f));
+
+  for (auto frequency : {100.0f, 1000.0f, 10000.0f})
+  {
+    const auto x = bounds.getX() + SpectrumAnalyzer::frequencyToX(frequency) * bounds.getWidth();
+    g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+  }
+
+  for (auto db = 0.0f; db > SpectrumAnalyzer::minDb; db -= 24.0f)
+  {
+    const auto y = bounds.getY() + SpectrumAnalyzer::levelToY(db) * bounds.getHeight();
+    g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+  }
+
+  g.setColour(juce::Colours::skyblue.withAlpha(0.5f));
+  g.strokePath(prePath, juce::PathStrokeType(1.0f), toBounds);
+
+  g.setColour(juce::Colours::orange);
+  g.strokePath(postPath, juce::PathStrokeType(1.5f), toBounds);
+
+  g.setColour(juce::Colours::white.withAlpha(0.6f));
+  g.setFont(juce::FontOptions(12.0f));
+  g.drawText("Pre", getLocalBounds().reduced(6, 4), juce::Justification::topLeft);
+  g.setColour(juce::Colours::orange);
+  g.drawText("Post", getLocalBounds().reduced(6, 4).withTrimmedLeft(30), juce::Justification::topLeft);
+}
+
+//==============================================================================
+ChainResponseDisplay::ChainResponseDisplay(AudioPluginAudioProcessor &p)
+    : audioProcessor(p)
+{
+  setOpaque(true);
+  audioProcessor.chainResponse.addClient();
+  startTimerHz(SpectrumAnalyzer::frameRateHz);
+}
+
+ChainResponseDisplay::~ChainResponseDisplay()
+{
+  stopTimer();
+  audioProcessor.chainResponse.removeClient();
+}
+
+void ChainResponseDisplay::timerCallback()
+{
+  audioProcessor.chainResponse.setRequest(audioProcessor.getChainResponseRequest());
+
+  const auto latestVersion = audioProcessor.chainResponse.getPaths(pathVersion, magnitudePath, phasePath);
+
+  if (latestVersion != pathVersion)
+  {
+    pathVersion = latestVersion;
+    repaint();
+  }
+}
+
+void ChainResponseDisplay::paint(juce::Graphics &g)
+{
+  g.fillAll(juce::Colours::black);
+
+  const auto bounds = getLocalBounds().toFloat().reduced(1.0f);
+  const auto toBounds = juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getX(), bounds.getY());
+
+  // Grid: decades of frequency and every 12 dB, with 0 dB brighter
+  for (auto frequency : {100.0f, 1000.0f, 10000.0f})
+  {
+    const auto x = bounds.getX() + ChainResponse::frequencyToX(frequency) * bounds.getWidth();
+    g.setColour(juce::Colours::white.withAlpha(0.15f));
+    g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+  }
+
+  for (auto db = -ChainResponse::rangeDb + 12.0f; db < ChainResponse::rangeDb; db += 12.0f)
+  {
+    const auto y = bounds.getY() + ChainResponse::levelToY(db) * bounds.getHeight();
+    g.setColour(juce::Colours::white.withAlpha(db == 0.0f ? 0.3f : 0.15f));
+    g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+  }
+
+  g.setColour(juce::Colours::violet.withAlpha(0.6f));
+  g.strokePath(phasePath, juce::PathStrokeType(1.0f), toBounds);
+
+  g.setColour(juce::Colours::limegreen);
+  g.strokePath(magnitudePath, juce::PathStrokeType(1.5f), toBounds);
+
+  g.setFont(juce::FontOptions(12.0f));
+  g.drawText("Magnitude +-" + juce::String(juce::roundToInt(ChainResponse::rangeDb)) + " dB", getLocalBounds().reduced(6, 4),
+             juce::Justification::topLeft);
+  g.setColour(juce::Colours::violet);
+  g.drawText("Phase", getLocalBounds().reduced(6, 4), juce::Justification::topRight);
+}
+
+#if AUDIO_PLUGIN_PROFILING
+//==============================================================================
+StageTimingDisplay::StageTimingDisplay(AudioPluginAudioProcessor &p)
+    : audioProcessor(p)
+{
+  startTimerHz(10);
+}
+
+void StageTimingDisplay::timerCallback()
+{
+  // Drain everything that queued up and keep the newest
+  bool updated = false;
+
+  while (audioProcessor.stageTimingFifo.pull(snapshot))
+    updated = true;
+
+  if (updated)
+  {
+    hasSnapshot = true;
+    repaint();
+  }
+}
+
+void StageTimingDisplay::paint(juce::Graphics &g)
+{
+  using DSP_OPTION = AudioPluginAudioProcessor::DSP_OPTION;
+
+  static const juce::StringArray stageNames{"Phaser", "Chorus", "WaveShaper", "Ladder Filter", "General Filter"};
+  jassert(stageNames.size() == static_cast<int>(DSP_OPTION::END_OF_LIST));
+
+  g.setColour(juce::Colours::black.withAlpha(0.3f));
+  g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.0f);
+
+  g.setColour(juce::Colours::white);
+  g.setFont(juce::FontOptions(13.0f));
+
+  auto bounds = getLocalBounds().reduced(6, 4);
+  const auto rowHeight = bounds.getHeight() / (stageNames.size() + 2);
+
+  auto drawRow = [&](const juce::String &name, const juce::String &average, const juce::String &worst, const juce::String &load)
+  {
+    auto row = bounds.removeFromTop(rowHeight);
+    const auto columnWidth = row.getWidth() / 4;
+
+    g.drawText(name, row.removeFromLeft(columnWidth), juce::Justification::centredLeft);
+    g.drawText(average, row.removeFromLeft(columnWidth), juce::Justification::centredRight);
+    g.drawText(worst, row.removeFromLeft(columnWidth), juce::Justification::centredRight);
+    g.drawText(load, row, juce::Justification::centredRight);
+  };
+
+  auto formatMs = [](double ms) { return juce::String(ms, 3) + " ms"; };
+  auto formatPercent = [](double percent) { return juce::String(percent, 1) + " %"; };
+
+  drawRow("Stage", "Average", "Worst", "% of block");
+
+  if (!hasSnapshot)
+    return;
+
+  for (int i = 0; i < stageNames.size(); ++i)
+  {
+    const auto stage = static_cast<size_t>(i);
+    drawRow(stageNames[i], formatMs(snapshot.stageAverageMs[stage]), formatMs(snapshot.stageWorstMs[stage]),
+            formatPercent(snapshot.stageAverageMs[stage] / snapshot.deadlineMs * 100.0));
+  }
+
+  drawRow("processBlock", formatMs(snapshot.blockAverageMs), formatMs(snapshot.blockWorstMs),
+          formatPercent(snapshot.averageLoadPercent) + " (worst " + formatPercent(snapshot.worstLoadPercent) + ")");
+}
+#endif
+
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
   // Make sure that before the constructor has finished, you've set the
   // editor's size to whatever you need it to be.
-  setSize(400, 300);
+  setSize(520, 1050);
 
   addAndMakeVisible(dspOrderLabel);
   dspOrderLabel.setText("DSP Chain: ", juce::dontSendNotification);
@@ -31,10 +225,51 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudi
     }
     dspOrderLabel.setText("DSP Chain: " + chain.trim(), juce::dontSendNotification);
   };
+
+  addAndMakeVisible(programBox);
+  refreshProgramList();
+  audioProcessor.addListener(this);
+  programBox.onChange = [this]()
+  {
+    if (programBox.getSelectedItemIndex() >= 0)
+      audioProcessor.setCurrentProgram(programBox.getSelectedItemIndex());
+  };
+
+  addAndMakeVisible(storeProgramButton);
+  storeProgramButton.onClick = [this]()
+  {
+    audioProcessor.storePreset(audioProcessor.getCurrentProgram());
+  };
+
+  addAndMakeVisible(spectrumDisplay);
+  addAndMakeVisible(chainResponseDisplay);
+
+#if AUDIO_PLUGIN_PROFILING
+  addAndMakeVisible(stageTimingDisplay);
+#endif
+
+  addAndMakeVisible(parameterEditor);
+}
+
+void AudioPluginAudioProcessorEditor::refreshProgramList()
+{
+  programBox.clear(juce::dontSendNotification);
+
+  for (int i = 0; i < audioProcessor.getNumPrograms(); ++i)
+    programBox.addItem(audioProcessor.getProgramName(i), i + 1);
+
+  programBox.setSelectedItemIndex(audioProcessor.getCurrentProgram(), juce::dontSendNotification);
 }
 
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
 {
+  audioProcessor.removeListener(this);
+}
+
+void AudioPluginAudioProcessorEditor::audioProcessorChanged(juce::AudioProcessor *, const ChangeDetails &details)
+{
+  if (details.programChanged)
+    triggerAsyncUpdate();
 }
 
 //==============================================================================
@@ -43,9 +278,6 @@ void AudioPluginAudioProcessorEditor::paint(juce::Graphics &g)
   // (Our component is opaque, so we must completely fill the background with a solid colour)
   g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
 
-  g.setColour(juce::Colours::white);
-  g.setFont(juce::FontOptions(15.0f));
-  g.drawFittedText("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void AudioPluginAudioProcessorEditor::resized()
@@ -55,4 +287,24 @@ void AudioPluginAudioProcessorEditor::resized()
   auto bounds = getLocalBounds().reduced(20);
   dspOrderLabel.setBounds(bounds.removeFromTop(30));
   refreshOrderButton.setBounds(bounds.removeFromTop(30));
+
+  bounds.removeFromTop(10);
+  auto programRow = bounds.removeFromTop(30);
+  storeProgramButton.setBounds(programRow.removeFromRight(80));
+  programRow.removeFromRight(10);
+  programBox.setBounds(programRow);
+
+  bounds.removeFromTop(10);
+  spectrumDisplay.setBounds(bounds.removeFromTop(160));
+
+  bounds.removeFromTop(10);
+  chainResponseDisplay.setBounds(bounds.removeFromTop(120));
+
+#if AUDIO_PLUGIN_PROFILING
+  bounds.removeFromTop(10);
+  stageTimingDisplay.setBounds(bounds.removeFromTop(140));
+#endif
+
+  bounds.removeFromTop(10);
+  parameterEditor.setBounds(bounds);
 }
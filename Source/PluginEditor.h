@@ -11,10 +11,75 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+//==============================================================================
+// Draws the input and output spectra from the processor's SpectrumAnalyzer. The paths are built on the
+// analyzer's thread; this only picks up new ones at the analyzer's frame rate and scales them to fit.
+class SpectrumDisplay : public juce::Component, private juce::Timer
+{
+public:
+  explicit SpectrumDisplay(AudioPluginAudioProcessor &);
+  ~SpectrumDisplay() override;
+
+  void paint(juce::Graphics &) override;
+
+private:
+  void timerCallback() override;
+
+  AudioPluginAudioProcessor &audioProcessor;
+  juce::Path prePath, postPath;
+  juce::uint32 pathVersion = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
+
+//==============================================================================
+// Draws the magnitude and phase response of the chain's linear stages. Polls the processor's parameters
+// at the display rate; ChainResponse only recomputes (on its own thread) when they changed.
+class ChainResponseDisplay : public juce::Component, private juce::Timer
+{
+public:
+  explicit ChainResponseDisplay(AudioPluginAudioProcessor &);
+  ~ChainResponseDisplay() override;
+
+  void paint(juce::Graphics &) override;
+
+private:
+  void timerCallback() override;
+
+  AudioPluginAudioProcessor &audioProcessor;
+  juce::Path magnitudePath, phasePath;
+  juce::uint32 pathVersion = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChainResponseDisplay)
+};
+
+#if AUDIO_PLUGIN_PROFILING
+//==============================================================================
+// Shows the per-stage timing the processor publishes through stageTimingFifo
+class StageTimingDisplay : public juce::Component, private juce::Timer
+{
+public:
+  explicit StageTimingDisplay(AudioPluginAudioProcessor &);
+
+  void paint(juce::Graphics &) override;
+
+private:
+  void timerCallback() override;
+
+  AudioPluginAudioProcessor &audioProcessor;
+  AudioPluginAudioProcessor::STAGE_PROFILER::Snapshot snapshot;
+  bool hasSnapshot = false;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageTimingDisplay)
+};
+#endif
+
 //==============================================================================
 /**
  */
-class AudioPluginAudioProcessorEditor : public juce::AudioProcessorEditor
+class AudioPluginAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                        private juce::AudioProcessorListener,
+                                        private juce::AsyncUpdater
 {
 public:
   AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor &);
@@ -32,5 +97,25 @@ private:
   juce::Label dspOrderLabel;
   juce::TextButton refreshOrderButton{"Refresh DSP Order"};
 
+  void refreshProgramList();
+
+  // The processor reports program changes and renames with updateHostDisplay(); the list is rebuilt on the
+  // message thread, whichever thread reported it
+  void audioProcessorParameterChanged(juce::AudioProcessor *, int, float) override {}
+  void audioProcessorChanged(juce::AudioProcessor *, const ChangeDetails &details) override;
+  void handleAsyncUpdate() override { refreshProgramList(); }
+
+  juce::ComboBox programBox;
+  juce::TextButton storeProgramButton{"Store"};
+
+  SpectrumDisplay spectrumDisplay{audioProcessor};
+  ChainResponseDisplay chainResponseDisplay{audioProcessor};
+
+#if AUDIO_PLUGIN_PROFILING
+  StageTimingDisplay stageTimingDisplay{audioProcessor};
+#endif
+
+  juce::GenericAudioProcessorEditor parameterEditor{audioProcessor};
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessorEditor)
 };
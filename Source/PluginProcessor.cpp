@@ -7,8 +7,9 @@
 */
 
 #include "PluginProcessor.h"
+#if !AUDIO_PLUGIN_HEADLESS
 #include "PluginEditor.h"
-#include <JucePluginDefines.h>
+#endif
 #include <juce_dsp/juce_dsp.h>
 
 // getters for Phaser parameters
@@ -17,6 +18,10 @@ auto getPhaserDepthName() { return juce::String("Phaser Depth %"); }
 auto getPhaserCentreFreqName() { return juce::String("Phaser CentreFreq Hz"); }
 auto getPhaserFeedbackName() { return juce::String("Phaser Feedback %"); }
 auto getPhaserMixName() { return juce::String("Phaser Mix %"); }
+auto getPhaserStagesName() { return juce::String("Phaser Stages"); }
+auto getPhaserStereoSpreadName() { return juce::String("Phaser Stereo Spread"); }
+constexpr float defaultPhaserStereoSpread = 90.0f; // degrees, for new instances
+constexpr float legacyPhaserStereoSpread = 0.0f;   // what sessions saved without the parameter were made with
 auto getPhaserBypassName() { return juce::String("Phaser Bypass"); }
 
 // getters for Chorus parameters
@@ -25,17 +30,50 @@ auto getChorusDepthName() { return juce::String("Chorus Depth %"); }
 auto getChorusCentreDelayName() { return juce::String("Chorus CentreDelay Ms"); }
 auto getChorusFeedbackName() { return juce::String("Chorus Feedback %"); }
 auto getChorusMixName() { return juce::String("Chorus Mix %"); }
+auto getChorusVoicesName() { return juce::String("Chorus Voices"); }
+auto getChorusInterpolationName() { return juce::String("Chorus Interpolation"); }
+auto getChorusInterpolationChoices()
+{
+    return juce::StringArray{"Linear", "Lagrange", "Thiran"};
+}
+auto getChorusStereoSpreadName() { return juce::String("Chorus Stereo Spread"); }
+constexpr float defaultChorusStereoSpread = 90.0f; // degrees, for new instances
+constexpr float legacyChorusStereoSpread = 0.0f;   // what sessions saved without the parameter were made with
 auto getChorusBypassName() { return juce::String("Chorus Bypass"); }
 
 // getters for WaveShaper parameters
 auto getWaveShaperSaturationName() { return juce::String("WaveShaper Saturation"); }
+auto getWaveShaperCurveName() { return juce::String("WaveShaper Curve"); }
+auto getWaveShaperCurveChoices()
+{
+    return juce::StringArray{"Tanh", "Tanh Approx", "Tanh Table", "Hard Clip", "Soft Clip"};
+}
+auto getWaveShaperOversamplingName() { return juce::String("WaveShaper Oversampling"); }
+auto getWaveShaperOversamplingFilterName() { return juce::String("WaveShaper Oversampling Filter"); }
 auto getWaveShaperBypassName() { return juce::String("WaveShaper Bypass"); }
 
+// getters for the oversampling options shared by the nonlinear stages
+auto getOversamplingChoices()
+{
+    return juce::StringArray{"Off", "2x", "4x", "8x"};
+}
+auto getOversamplingFilterChoices()
+{
+    return juce::StringArray{"Polyphase IIR", "Linear Phase FIR"};
+}
+
 // getters for Ladder Filter parameters
 auto getLadderFilterCutoffName() { return juce::String("Ladder Filter Cutoff Hz"); }
 auto getLadderFilterResonanceName() { return juce::String("Ladder Filter Resonance"); }
 auto getLadderFilterDriveName() { return juce::String("Ladder Filter Drive"); }
 auto getLadderFilterModeName() { return juce::String("Ladder Filter Mode"); }
+auto getLadderFilterQualityName() { return juce::String("Ladder Filter Quality"); }
+auto getLadderFilterQualityChoices()
+{
+    return juce::StringArray{"Eco", "Normal", "HQ"};
+}
+auto getLadderFilterOversamplingName() { return juce::String("Ladder Filter Oversampling"); }
+auto getLadderFilterOversamplingFilterName() { return juce::String("Ladder Filter Oversampling Filter"); }
 auto getLadderFilterBypassName() { return juce::String("Ladder Filter Bypass"); }
 
 // getters for General Filter parameters
@@ -49,16 +87,190 @@ auto getGeneralFilterQualityName() { return juce::String("General Filter Quality
 auto getGeneralFilterGainName() { return juce::String("General Filter Gain dB"); }
 auto getGeneralFilterBypassName() { return juce::String("General Filter Bypass"); }
 
+// getters for modulation options
+auto getModLfoRateName(size_t index) { return "Mod LFO " + juce::String(static_cast<int>(index) + 1) + " Rate Hz"; }
+auto getModLfoShapeName(size_t index) { return "Mod LFO " + juce::String(static_cast<int>(index) + 1) + " Shape"; }
+auto getModLfoShapeChoices()
+{
+    return juce::StringArray{"Sine", "Triangle", "Saw", "Square"};
+}
+auto getModEnvelopeAttackName(size_t index) { return "Mod Env " + juce::String(static_cast<int>(index) + 1) + " Attack Ms"; }
+auto getModEnvelopeReleaseName(size_t index) { return "Mod Env " + juce::String(static_cast<int>(index) + 1) + " Release Ms"; }
+auto getModSlotSourceName(size_t index) { return "Mod Slot " + juce::String(static_cast<int>(index) + 1) + " Source"; }
+auto getModSlotSourceChoices()
+{
+    juce::StringArray choices{"Off"};
+
+    for (size_t i = 0; i < ModulationMatrix::numLfos; ++i)
+        choices.add("LFO " + juce::String(static_cast<int>(i) + 1));
+
+    for (size_t i = 0; i < ModulationMatrix::numEnvelopes; ++i)
+        choices.add("Env " + juce::String(static_cast<int>(i) + 1));
+
+    return choices;
+}
+auto getModSlotTargetName(size_t index) { return "Mod Slot " + juce::String(static_cast<int>(index) + 1) + " Target"; }
+auto getModSlotAmountName(size_t index) { return "Mod Slot " + juce::String(static_cast<int>(index) + 1) + " Amount %"; }
+
+// getters for processing options
+auto getSubBlockSizeName() { return juce::String("Processing Sub Block"); }
+auto getSubBlockSizeChoices()
+{
+    return juce::StringArray{"16", "32", "64", "128", "256", "Host Block"};
+}
+auto getCrossfadeName() { return juce::String("Processing Crossfade Ms"); }
+auto getWorkerThreadsName() { return juce::String("Processing Worker Threads"); }
+auto getParallelThresholdName() { return juce::String("Processing Parallel Threshold"); }
+
+// getters for preset options
+auto getPresetMorphName() { return juce::String("Preset Morph"); }
+auto getPresetMorphTargetName() { return juce::String("Preset Morph Target"); }
+auto getPresetMorphTargetChoices()
+{
+    juce::StringArray choices;
+
+    for (int i = 1; i <= AudioPluginAudioProcessor::numPresets; ++i)
+        choices.add(juce::String(i));
+
+    return choices;
+}
+
+// Parameters that are settings of the plugin rather than part of the sound, so presets leave them alone
+bool isOptionParameter(const juce::String &parameterID)
+{
+    return parameterID.startsWith("Processing ") || parameterID.startsWith("Preset ");
+}
+
+// Sets a parameter that an older session did not save to the value that session was made with
+void setParameterToLegacyValue(juce::AudioProcessorValueTreeState &apvts, const juce::String &parameterID, float value)
+{
+    if (auto *parameter = apvts.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Binary state layout, all little endian:
+//   "APST" magic, uint16 version,
+//   uint8 order length, one DSP_OPTION byte per slot,
+//   uint16 parameter count, then per parameter a uint32 FNV-1a hash of its ID and its float value,
+// then from version 2 the program bank:
+//   uint16 current program, uint16 preset count, then per preset its name (null terminated UTF-8),
+//   its order and its sound parameters, laid out like the order and parameters above
+constexpr char binaryStateMagic[] = {'A', 'P', 'S', 'T'};
+constexpr int binaryStateVersion = 2;
+
+juce::uint32 hashParameterID(const juce::String &parameterID)
+{
+    juce::uint32 hash = 2166136261u;
+
+    for (auto *c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8>(*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Parameter name and owning module of every smoothed float parameter
+std::pair<juce::String, AudioPluginAudioProcessor::DSP_OPTION> getFloatParameterInfo(AudioPluginAudioProcessor::FLOAT_PARAM param)
+{
+    using DSP_OPTION = AudioPluginAudioProcessor::DSP_OPTION;
+    using FLOAT_PARAM = AudioPluginAudioProcessor::FLOAT_PARAM;
+
+    switch (param)
+    {
+    case FLOAT_PARAM::PhaserRate: return {getPhaserRateName(), DSP_OPTION::Phase};
+    case FLOAT_PARAM::PhaserDepth: return {getPhaserDepthName(), DSP_OPTION::Phase};
+    case FLOAT_PARAM::PhaserCentreFreq: return {getPhaserCentreFreqName(), DSP_OPTION::Phase};
+    case FLOAT_PARAM::PhaserFeedback: return {getPhaserFeedbackName(), DSP_OPTION::Phase};
+    case FLOAT_PARAM::PhaserMix: return {getPhaserMixName(), DSP_OPTION::Phase};
+    case FLOAT_PARAM::ChorusRate: return {getChorusRateName(), DSP_OPTION::Chorus};
+    case FLOAT_PARAM::ChorusDepth: return {getChorusDepthName(), DSP_OPTION::Chorus};
+    case FLOAT_PARAM::ChorusCentreDelay: return {getChorusCentreDelayName(), DSP_OPTION::Chorus};
+    case FLOAT_PARAM::ChorusFeedback: return {getChorusFeedbackName(), DSP_OPTION::Chorus};
+    case FLOAT_PARAM::ChorusMix: return {getChorusMixName(), DSP_OPTION::Chorus};
+    case FLOAT_PARAM::WaveShaperSaturation: return {getWaveShaperSaturationName(), DSP_OPTION::WaveShaper};
+    case FLOAT_PARAM::LadderFilterCutoff: return {getLadderFilterCutoffName(), DSP_OPTION::LadderFilter};
+    case FLOAT_PARAM::LadderFilterResonance: return {getLadderFilterResonanceName(), DSP_OPTION::LadderFilter};
+    case FLOAT_PARAM::LadderFilterDrive: return {getLadderFilterDriveName(), DSP_OPTION::LadderFilter};
+    case FLOAT_PARAM::GeneralFilterFreq: return {getGeneralFilterFreqName(), DSP_OPTION::GeneralFilter};
+    case FLOAT_PARAM::GeneralFilterQuality: return {getGeneralFilterQualityName(), DSP_OPTION::GeneralFilter};
+    case FLOAT_PARAM::GeneralFilterGain: return {getGeneralFilterGainName(), DSP_OPTION::GeneralFilter};
+    default: break;
+    }
+
+    jassertfalse;
+    return {};
+}
+
+// Every smoothed float parameter can be a modulation target, in FLOAT_PARAM order
+juce::StringArray getModSlotTargetChoices()
+{
+    juce::StringArray choices;
+
+    for (size_t i = 0; i < static_cast<size_t>(AudioPluginAudioProcessor::FLOAT_PARAM::END_OF_LIST); ++i)
+        choices.add(getFloatParameterInfo(static_cast<AudioPluginAudioProcessor::FLOAT_PARAM>(i)).first);
+
+    return choices;
+}
+
+// Parameters that change the modulation sources or routings
+juce::StringArray getModulationParameterNames()
+{
+    juce::StringArray names;
+
+    for (size_t i = 0; i < ModulationMatrix::numLfos; ++i)
+        names.addArray({getModLfoRateName(i), getModLfoShapeName(i)});
+
+    for (size_t i = 0; i < ModulationMatrix::numEnvelopes; ++i)
+        names.addArray({getModEnvelopeAttackName(i), getModEnvelopeReleaseName(i)});
+
+    for (size_t i = 0; i < ModulationMatrix::maxRoutings; ++i)
+        names.addArray({getModSlotSourceName(i), getModSlotTargetName(i), getModSlotAmountName(i)});
+
+    return names;
+}
+
+// Parameters that require a module to be reconfigured when they change.
+// Bypass flags are read directly in processBlock, so they are not listed here.
+juce::StringArray getModuleParameterNames(AudioPluginAudioProcessor::DSP_OPTION option)
+{
+    using DSP_OPTION = AudioPluginAudioProcessor::DSP_OPTION;
+
+    switch (option)
+    {
+    case DSP_OPTION::Phase:
+        return {getPhaserRateName(), getPhaserDepthName(), getPhaserCentreFreqName(),
+                getPhaserFeedbackName(), getPhaserMixName(), getPhaserStagesName(), getPhaserStereoSpreadName()};
+    case DSP_OPTION::Chorus:
+        return {getChorusRateName(), getChorusDepthName(), getChorusCentreDelayName(),
+                getChorusFeedbackName(), getChorusMixName(), getChorusVoicesName(), getChorusInterpolationName(),
+                getChorusStereoSpreadName()};
+    case DSP_OPTION::WaveShaper:
+        return {getWaveShaperSaturationName(), getWaveShaperCurveName(),
+                getWaveShaperOversamplingName(), getWaveShaperOversamplingFilterName()};
+    case DSP_OPTION::LadderFilter:
+        return {getLadderFilterCutoffName(), getLadderFilterResonanceName(),
+                getLadderFilterDriveName(), getLadderFilterModeName(), getLadderFilterQualityName(),
+                getLadderFilterOversamplingName(), getLadderFilterOversamplingFilterName()};
+    case DSP_OPTION::GeneralFilter:
+        return {getGeneralFilterModeName(), getGeneralFilterFreqName(),
+                getGeneralFilterQualityName(), getGeneralFilterGainName()};
+    default:
+        break;
+    }
+
+    return {};
+}
+
 //==============================================================================
 AudioPluginAudioProcessor::AudioPluginAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(BusesProperties()
 #if !JucePlugin_IsMidiEffect
 #if !JucePlugin_IsSynth
-                         .withInput("Input", juce::AudioChannelSet::mono(), true)
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
 #endif
-                         .withOutput("Output", juce::AudioChannelSet::mono(), true)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
                          ),
@@ -67,57 +279,189 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
     : apvts(*this, nullptr, "Parameters", createParameterLayout())
 #endif
 {
-    // Initialize DSP order and map instances
+    // Initialize DSP order; its chain is built in prepareToPlay
     dspOrder = {DSP_OPTION::Phase, DSP_OPTION::Chorus, DSP_OPTION::WaveShaper, DSP_OPTION::LadderFilter,
                 DSP_OPTION::GeneralFilter};
-    dspInstances = {&phaser, &chorus, &waveShaper, &ladderFilter, &generalFilter};
+
+    // Index the sound parameters for presets first, so each one below can take its slot
+    for (auto *parameter : getParameters())
+    {
+        auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter);
+
+        if (ranged == nullptr || isOptionParameter(ranged->getParameterID()))
+            continue;
+
+        const auto discrete = dynamic_cast<juce::AudioParameterFloat *>(ranged) == nullptr;
+        presetSources.push_back({apvts.getRawParameterValue(ranged->getParameterID()), ranged, discrete,
+                                 hashParameterID(ranged->getParameterID())});
+    }
+
+    std::sort(presetSources.begin(), presetSources.end(),
+              [](const auto &a, const auto &b) { return std::less<>()(a.source, b.source); });
 
     // Set up Phaser parameters
-    phaserParams.rateHz = apvts.getRawParameterValue(getPhaserRateName());
-    phaserParams.depthPercent = apvts.getRawParameterValue(getPhaserDepthName());
-    phaserParams.centerFreqHz = apvts.getRawParameterValue(getPhaserCentreFreqName());
-    phaserParams.feedbackPercent = apvts.getRawParameterValue(getPhaserFeedbackName());
-    phaserParams.mixPercent = apvts.getRawParameterValue(getPhaserMixName());
-    phaserParams.bypass = reinterpret_cast<std::atomic<bool> *>(apvts.getRawParameterValue(getPhaserBypassName()));
+    phaserParams.rateHz = getSoundParameter(getPhaserRateName());
+    phaserParams.depthPercent = getSoundParameter(getPhaserDepthName());
+    phaserParams.centerFreqHz = getSoundParameter(getPhaserCentreFreqName());
+    phaserParams.feedbackPercent = getSoundParameter(getPhaserFeedbackName());
+    phaserParams.mixPercent = getSoundParameter(getPhaserMixName());
+    phaserParams.stages = getSoundParameter(getPhaserStagesName());
+    phaserParams.stereoSpread = getSoundParameter(getPhaserStereoSpreadName());
+    phaserParams.bypass = getSoundParameter(getPhaserBypassName());
     jassert(phaserParams.rateHz && phaserParams.depthPercent && phaserParams.centerFreqHz &&
-            phaserParams.feedbackPercent && phaserParams.mixPercent && phaserParams.bypass);
+            phaserParams.feedbackPercent && phaserParams.mixPercent && phaserParams.stages && phaserParams.stereoSpread &&
+            phaserParams.bypass);
 
     // Set up Chorus parameters
-    chorusParams.rateHz = apvts.getRawParameterValue(getChorusRateName());
-    chorusParams.depthPercent = apvts.getRawParameterValue(getChorusDepthName());
-    chorusParams.centerDelayMs = apvts.getRawParameterValue(getChorusCentreDelayName());
-    chorusParams.feedbackPercent = apvts.getRawParameterValue(getChorusFeedbackName());
-    chorusParams.mixPercent = apvts.getRawParameterValue(getChorusMixName());
-    chorusParams.bypass = reinterpret_cast<std::atomic<bool> *>(apvts.getRawParameterValue(getChorusBypassName()));
+    chorusParams.rateHz = getSoundParameter(getChorusRateName());
+    chorusParams.depthPercent = getSoundParameter(getChorusDepthName());
+    chorusParams.centerDelayMs = getSoundParameter(getChorusCentreDelayName());
+    chorusParams.feedbackPercent = getSoundParameter(getChorusFeedbackName());
+    chorusParams.mixPercent = getSoundParameter(getChorusMixName());
+    chorusParams.voices = getSoundParameter(getChorusVoicesName());
+    chorusParams.interpolation = getSoundParameter(getChorusInterpolationName());
+    chorusParams.stereoSpread = getSoundParameter(getChorusStereoSpreadName());
+    chorusParams.bypass = getSoundParameter(getChorusBypassName());
     jassert(chorusParams.rateHz && chorusParams.depthPercent && chorusParams.centerDelayMs &&
-            chorusParams.feedbackPercent && chorusParams.mixPercent && chorusParams.bypass);
+            chorusParams.feedbackPercent && chorusParams.mixPercent && chorusParams.voices &&
+            chorusParams.interpolation && chorusParams.stereoSpread && chorusParams.bypass);
 
     // Set up WaveShaper parameters
-    waveShaperParams.saturation = apvts.getRawParameterValue(getWaveShaperSaturationName());
-    waveShaperParams.bypass = reinterpret_cast<std::atomic<bool> *>(apvts.getRawParameterValue(getWaveShaperBypassName()));
-    jassert(waveShaperParams.saturation && waveShaperParams.bypass);
+    waveShaperParams.saturation = getSoundParameter(getWaveShaperSaturationName());
+    waveShaperParams.curve = getSoundParameter(getWaveShaperCurveName());
+    waveShaperParams.oversampling = getSoundParameter(getWaveShaperOversamplingName());
+    waveShaperParams.oversamplingFilter = getSoundParameter(getWaveShaperOversamplingFilterName());
+    waveShaperParams.bypass = getSoundParameter(getWaveShaperBypassName());
+    jassert(waveShaperParams.saturation && waveShaperParams.curve && waveShaperParams.oversampling &&
+            waveShaperParams.oversamplingFilter && waveShaperParams.bypass);
 
     // Set up Ladder Filter parameters
-    ladderFilterParams.cutoffHz = apvts.getRawParameterValue(getLadderFilterCutoffName());
-    ladderFilterParams.resonance = apvts.getRawParameterValue(getLadderFilterResonanceName());
-    ladderFilterParams.drive = apvts.getRawParameterValue(getLadderFilterDriveName());
-    ladderFilterParams.mode = reinterpret_cast<std::atomic<int> *>(apvts.getRawParameterValue(getLadderFilterModeName()));
-    ladderFilterParams.bypass = reinterpret_cast<std::atomic<bool> *>(apvts.getRawParameterValue(getLadderFilterBypassName()));
-    jassert(ladderFilterParams.cutoffHz && ladderFilterParams.resonance &&
-            ladderFilterParams.drive && ladderFilterParams.mode && ladderFilterParams.bypass);
+    ladderFilterParams.cutoffHz = getSoundParameter(getLadderFilterCutoffName());
+    ladderFilterParams.resonance = getSoundParameter(getLadderFilterResonanceName());
+    ladderFilterParams.drive = getSoundParameter(getLadderFilterDriveName());
+    ladderFilterParams.mode = getSoundParameter(getLadderFilterModeName());
+    ladderFilterParams.quality = getSoundParameter(getLadderFilterQualityName());
+    ladderFilterParams.oversampling = getSoundParameter(getLadderFilterOversamplingName());
+    ladderFilterParams.oversamplingFilter = getSoundParameter(getLadderFilterOversamplingFilterName());
+    ladderFilterParams.bypass = getSoundParameter(getLadderFilterBypassName());
+    jassert(ladderFilterParams.cutoffHz && ladderFilterParams.resonance && ladderFilterParams.drive &&
+            ladderFilterParams.mode && ladderFilterParams.quality && ladderFilterParams.oversampling && ladderFilterParams.oversamplingFilter &&
+            ladderFilterParams.bypass);
 
     // Set up General Filter parameters
-    generalFilterParams.mode = reinterpret_cast<std::atomic<int> *>(apvts.getRawParameterValue(getGeneralFilterModeName()));
-    generalFilterParams.freqHz = apvts.getRawParameterValue(getGeneralFilterFreqName());
-    generalFilterParams.quality = apvts.getRawParameterValue(getGeneralFilterQualityName());
-    generalFilterParams.gainDb = apvts.getRawParameterValue(getGeneralFilterGainName());
-    generalFilterParams.bypass = reinterpret_cast<std::atomic<bool> *>(apvts.getRawParameterValue(getGeneralFilterBypassName()));
+    generalFilterParams.mode = getSoundParameter(getGeneralFilterModeName());
+    generalFilterParams.freqHz = getSoundParameter(getGeneralFilterFreqName());
+    generalFilterParams.quality = getSoundParameter(getGeneralFilterQualityName());
+    generalFilterParams.gainDb = getSoundParameter(getGeneralFilterGainName());
+    generalFilterParams.bypass = getSoundParameter(getGeneralFilterBypassName());
     jassert(generalFilterParams.mode && generalFilterParams.freqHz &&
             generalFilterParams.quality && generalFilterParams.gainDb && generalFilterParams.bypass);
+
+    // Set up modulation parameters
+    for (size_t i = 0; i < ModulationMatrix::numLfos; ++i)
+    {
+        modulationParams.lfoRateHz[i] = getSoundParameter(getModLfoRateName(i));
+        modulationParams.lfoShape[i] = getSoundParameter(getModLfoShapeName(i));
+        jassert(modulationParams.lfoRateHz[i] && modulationParams.lfoShape[i]);
+    }
+
+    for (size_t i = 0; i < ModulationMatrix::numEnvelopes; ++i)
+    {
+        modulationParams.envelopeAttackMs[i] = getSoundParameter(getModEnvelopeAttackName(i));
+        modulationParams.envelopeReleaseMs[i] = getSoundParameter(getModEnvelopeReleaseName(i));
+        jassert(modulationParams.envelopeAttackMs[i] && modulationParams.envelopeReleaseMs[i]);
+    }
+
+    for (size_t i = 0; i < ModulationMatrix::maxRoutings; ++i)
+    {
+        modulationParams.slotSource[i] = getSoundParameter(getModSlotSourceName(i));
+        modulationParams.slotTarget[i] = getSoundParameter(getModSlotTargetName(i));
+        modulationParams.slotAmountPercent[i] = getSoundParameter(getModSlotAmountName(i));
+        jassert(modulationParams.slotSource[i] && modulationParams.slotTarget[i] && modulationParams.slotAmountPercent[i]);
+    }
+
+    // Set up processing options
+    processingParams.subBlockSize = apvts.getRawParameterValue(getSubBlockSizeName());
+    processingParams.crossfadeMs = apvts.getRawParameterValue(getCrossfadeName());
+    processingParams.workerThreads = apvts.getRawParameterValue(getWorkerThreadsName());
+    processingParams.parallelThreshold = apvts.getRawParameterValue(getParallelThresholdName());
+    jassert(processingParams.subBlockSize && processingParams.crossfadeMs && processingParams.workerThreads &&
+            processingParams.parallelThreshold);
+
+    // Set up preset options
+    presetParams.morph = apvts.getRawParameterValue(getPresetMorphName());
+    presetParams.morphTarget = apvts.getRawParameterValue(getPresetMorphTargetName());
+    jassert(presetParams.morph && presetParams.morphTarget);
+
+    // Map the smoothed float parameters to their sources and modules
+    for (size_t i = 0; i < numFloatParams; ++i)
+    {
+        auto [name, module] = getFloatParameterInfo(static_cast<FLOAT_PARAM>(i));
+        floatParamSources[i] = getSoundParameter(name);
+        floatParamRanges[i] = apvts.getParameterRange(name);
+        floatParamModules[i] = module;
+        jassert(floatParamSources[i]);
+    }
+
+    // Index the parameters for the binary state
+    for (auto *parameter : getParameters())
+    {
+        if (auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter))
+            parametersByHash.emplace_back(hashParameterID(ranged->getParameterID()), ranged);
+    }
+
+    std::sort(parametersByHash.begin(), parametersByHash.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    jassert(std::adjacent_find(parametersByHash.begin(), parametersByHash.end(),
+                               [](const auto &a, const auto &b) { return a.first == b.first; }) == parametersByHash.end());
+
+    // Fill the bank with the initial state
+    for (int i = 0; i < numPresets; ++i)
+        presets[static_cast<size_t>(i)].store(capturePreset("Preset " + juce::String(i + 1)).release());
+
+    // Track parameter changes per module
+    for (size_t i = 0; i < moduleListeners.size(); ++i)
+    {
+        for (auto &name : getModuleParameterNames(static_cast<DSP_OPTION>(i)))
+            apvts.addParameterListener(name, &moduleListeners[i]);
+    }
+
+    for (auto &name : getModulationParameterNames())
+        apvts.addParameterListener(name, &modulationListener);
+
+    wakeTimer();
+}
+
+const std::array<int, 6> &AudioPluginAudioProcessor::getSubBlockSizes()
+{
+    static const std::array<int, 6> sizes{16, 32, 64, 128, 256, 0};
+    return sizes;
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
 {
+    stopTimer();
+
+    {
+        const juce::ScopedLock lock(chainBuildLock);
+        delete pendingChain.exchange(nullptr);
+        collectRetiredChains();
+
+        for (size_t i = 0; i < presets.size(); ++i)
+        {
+            delete presets[i].exchange(nullptr);
+            delete presetChains[i].exchange(nullptr);
+        }
+    }
+
+    for (size_t i = 0; i < moduleListeners.size(); ++i)
+    {
+        for (auto &name : getModuleParameterNames(static_cast<DSP_OPTION>(i)))
+            apvts.removeParameterListener(name, &moduleListeners[i]);
+    }
+
+    for (auto &name : getModulationParameterNames())
+        apvts.removeParameterListener(name, &modulationListener);
 }
 
 //==============================================================================
@@ -155,152 +499,1244 @@ bool AudioPluginAudioProcessor::isMidiEffect() const
 
 double AudioPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load(std::memory_order_relaxed);
 }
 
 int AudioPluginAudioProcessor::getNumPrograms()
 {
-    return 1; // NB: some hosts don't cope very well if you tell them there are 0 programs,
-              // so this should be at least 1, even if you're not really implementing programs.
+    return numPresets;
 }
 
 int AudioPluginAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load(std::memory_order_relaxed);
 }
 
 void AudioPluginAudioProcessor::setCurrentProgram(int index)
 {
-    juce::ignoreUnused(index);
+    // Hosts may call this from the audio thread (e.g. automated program changes), so it only hands over an index.
+    // The audio thread recalls the preset at its next block. The parameters and order follow straight away on
+    // the message thread, or at the next timer tick from anywhere else, so the change lands without audio too.
+    if (index < 0 || index >= numPresets)
+        return;
+
+    currentProgram.store(index, std::memory_order_relaxed);
+    pendingProgram.store(index, std::memory_order_release);
+    programsChanged.store(true, std::memory_order_release);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        applyPreset(*presets[static_cast<size_t>(index)].load(std::memory_order_acquire));
+        wakeTimer(); // for the host and editor notification
+        return;
+    }
+
+    unappliedProgram.store(index, std::memory_order_release);
+
+    // Without audio running this cannot be the audio thread; otherwise the idle timer picks the change up
+    if (!audioActive.load(std::memory_order_acquire))
+        wakeTimer();
 }
 
 const juce::String AudioPluginAudioProcessor::getProgramName(int index)
 {
-    juce::ignoreUnused(index);
-    return {};
+    if (index < 0 || index >= numPresets)
+        return {};
+
+    return presets[static_cast<size_t>(index)].load(std::memory_order_acquire)->name;
 }
 
 void AudioPluginAudioProcessor::changeProgramName(int index, const juce::String &newName)
 {
-    juce::ignoreUnused(index, newName);
+    if (index < 0 || index >= numPresets)
+        return;
+
+    auto renamed = std::make_unique<PRESET>(*presets[static_cast<size_t>(index)].load(std::memory_order_acquire));
+    renamed->name = newName;
+    replacePreset(index, std::move(renamed));
+}
+
+void AudioPluginAudioProcessor::storePreset(int index)
+{
+    if (index < 0 || index >= numPresets)
+        return;
+
+    replacePreset(index, capturePreset(getProgramName(index)));
+}
+
+std::unique_ptr<AudioPluginAudioProcessor::PRESET> AudioPluginAudioProcessor::capturePreset(const juce::String &name) const
+{
+    auto preset = std::make_unique<PRESET>();
+    preset->name = name;
+    preset->order = dspOrder;
+    preset->values.reserve(presetSources.size());
+
+    for (const auto &source : presetSources)
+        preset->values.push_back(source.source->load());
+
+    computePresetCoefficients(*preset);
+    return preset;
+}
+
+void AudioPluginAudioProcessor::computePresetCoefficients(PRESET &preset) const
+{
+    using Mode = BiquadCoefficients::Mode;
+
+    const auto sampleRate = generalFilterCoefficients.getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return; // prepareToPlay computes them once the rate is known
+
+    auto valueOf = [&](const SOUND_PARAMETER &parameter) { return preset.values[static_cast<size_t>(parameter.presetIndex)]; };
+
+    auto mode = static_cast<int>(valueOf(generalFilterParams.mode));
+
+    if (mode < 0 || mode >= static_cast<int>(Mode::END_OF_LIST))
+        mode = static_cast<int>(Mode::Peak);
+
+    preset.generalFilterCoefficients.compute(static_cast<Mode>(mode), sampleRate, valueOf(generalFilterParams.freqHz),
+                                             valueOf(generalFilterParams.quality), valueOf(generalFilterParams.gainDb));
+}
+
+void AudioPluginAudioProcessor::replacePreset(int index, std::unique_ptr<PRESET> preset)
+{
+    const auto slot = static_cast<size_t>(index);
+    const juce::ScopedLock lock(chainBuildLock);
+
+    std::unique_ptr<PRESET> replaced(presets[slot].exchange(preset.release(), std::memory_order_acq_rel));
+
+    // Before prepareToPlay no audio thread can have read it
+    if (isPrepared)
+        retiredPresets.push_back({std::move(replaced), processedBlocks.load(std::memory_order_acquire)});
+
+    programsChanged.store(true, std::memory_order_release); // the name may have changed
+
+    // The chain prepared for the old preset may have the wrong order now
+    delete presetChains[slot].exchange(nullptr, std::memory_order_acq_rel);
+    refillPresetChains();
+    wakeTimer();
+}
+
+void AudioPluginAudioProcessor::collectRetiredPresets()
+{
+    // Called with chainBuildLock held. Once a block has finished since a preset was replaced, the audio thread
+    // can only still reach it through what it holds across blocks (published by acknowledgePresets), and the
+    // handshake compares recalled and synced presets by address, so those stay as well.
+    const auto blocks = processedBlocks.load(std::memory_order_acquire);
+
+    auto isHeld = [this](const PRESET *preset)
+    {
+        return preset == presetsInUse[0].load(std::memory_order_relaxed) || preset == presetsInUse[1].load(std::memory_order_relaxed) ||
+               preset == recalledPreset.load(std::memory_order_acquire) || preset == syncedPreset.load(std::memory_order_acquire);
+    };
+
+    retiredPresets.erase(std::remove_if(retiredPresets.begin(), retiredPresets.end(),
+                                        [&](const RETIRED_PRESET &retired)
+                                        { return retired.retiredAt != blocks && !isHeld(retired.preset.get()); }),
+                         retiredPresets.end());
+}
+
+void AudioPluginAudioProcessor::acknowledgePresets()
+{
+    // Audio thread, at the end of every block: the presets it keeps for the next one, then the block count
+    presetsInUse[0].store(presetA, std::memory_order_relaxed);
+    presetsInUse[1].store(presetB, std::memory_order_relaxed);
+    processedBlocks.fetch_add(1, std::memory_order_release);
+}
+
+void AudioPluginAudioProcessor::refillPresetChains()
+{
+    // Called with chainBuildLock held. Recalling a preset with a different order swaps in its
+    // prepared chain on the audio thread; the ones used up are rebuilt here.
+    if (!isPrepared)
+        return;
+
+    for (size_t i = 0; i < presets.size(); ++i)
+    {
+        if (presetChains[i].load(std::memory_order_acquire) != nullptr)
+            continue;
+
+        auto chain = createChain(presets[i].load(std::memory_order_acquire)->order);
+        DSP_CHAIN *expected = nullptr;
+
+        if (presetChains[i].compare_exchange_strong(expected, chain.get(), std::memory_order_acq_rel))
+            chain.release();
+    }
+}
+
+void AudioPluginAudioProcessor::applyPreset(const PRESET &preset)
+{
+    // Message thread: the host-visible parameters and the order take the preset's values. The chain is left to
+    // the audio thread's recall, which swaps in the one prepared for the preset, or to prepareToPlay.
+    {
+        const juce::ScopedLock lock(chainBuildLock);
+        dspOrder = preset.order;
+    }
+
+    for (size_t i = 0; i < presetSources.size(); ++i)
+    {
+        auto &source = presetSources[i];
+
+        if (source.source->load() != preset.values[i])
+            source.parameter->setValueNotifyingHost(source.parameter->convertTo0to1(preset.values[i]));
+    }
+}
+
+void AudioPluginAudioProcessor::syncRecalledPreset()
+{
+    // Message thread: apply a program change made off the message thread
+    const auto index = unappliedProgram.exchange(-1, std::memory_order_acq_rel);
+
+    if (index >= 0)
+        applyPreset(*presets[static_cast<size_t>(index)].load(std::memory_order_acquire));
+
+    // Bring the parameters and the order in line with a preset the audio thread has recalled (usually they
+    // already are), then release the audio thread's override
+    auto *preset = recalledPreset.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (preset == nullptr)
+        return;
+
+    applyPreset(*preset);
+
+    {
+        const juce::ScopedLock lock(chainBuildLock);
+
+        // Without a prepared chain at hand, the audio thread left the order change to us
+        if (presetChainMissing.exchange(false) && isPrepared)
+            publishChain(createChain(dspOrder));
+    }
+
+    syncedPreset.store(preset, std::memory_order_release);
+}
+
+void AudioPluginAudioProcessor::pickUpPendingPreset()
+{
+    // Once the parameters hold the recalled preset, they are what the audio thread follows again
+    if (recallPending && syncedPreset.load(std::memory_order_acquire) == presetA)
+    {
+        recallPending = false;
+        presetA = nullptr;
+        reconfigureAll = true;
+    }
+
+    const auto index = pendingProgram.exchange(-1, std::memory_order_acq_rel);
+
+    if (index < 0)
+        return;
+
+    const auto slot = static_cast<size_t>(index);
+    auto *preset = presets[slot].load(std::memory_order_acquire);
+
+    presetA = preset;
+    recallPending = true;
+    presetOverride = true; // so the fades of a swapped-in chain already follow the preset's bypasses
+    reconfigureAll = true;
+
+    // A different order: hand the chain prepared for this preset to the usual transition. If there is none
+    // (or no room to retire what it replaces), the message thread builds one when it syncs the preset.
+    if (activeChain != nullptr && preset->order != activeChain->order)
+    {
+        DSP_CHAIN *chain = nullptr;
+
+        if (retiredChains.getNumAvailableForReading() < maxRetiredChains)
+            chain = presetChains[slot].exchange(nullptr, std::memory_order_acq_rel);
+
+        // Built for the preset this slot held before a store the message thread is still finishing
+        if (chain != nullptr && chain->order != preset->order)
+        {
+            retiredChains.push(chain);
+            chain = nullptr;
+        }
+
+        if (chain == nullptr)
+            presetChainMissing.store(true);
+        else if (auto *replaced = pendingChain.exchange(chain, std::memory_order_acq_rel))
+            retiredChains.push(replaced);
+    }
+
+    // Published last, so the message thread sees presetChainMissing along with the preset
+    syncedPreset.store(nullptr, std::memory_order_release);
+    recalledPreset.store(preset, std::memory_order_release);
+}
+
+void AudioPluginAudioProcessor::advancePresetMorph(int numSamples)
+{
+    const auto index = juce::jlimit(0, numPresets - 1, static_cast<int>(presetParams.morphTarget->load()));
+    auto *target = presets[static_cast<size_t>(index)].load(std::memory_order_acquire);
+
+    presetMorph.setTargetValue(presetParams.morph->load());
+
+    // Every module follows the morph, including its discrete settings, so a moving morph reconfigures all of them
+    if (presetMorph.isSmoothing() || (target != presetB && presetMorph.getCurrentValue() > 0.0f))
+    {
+        presetMorph.skip(numSamples);
+        reconfigureAll = true;
+    }
+
+    presetB = target;
+
+    const auto overridden = recallPending || (presetB != nullptr && presetMorph.getCurrentValue() > 0.0f);
+
+    if (overridden != presetOverride)
+        reconfigureAll = true;
+
+    presetOverride = overridden;
+}
+
+AudioPluginAudioProcessor::SOUND_PARAMETER AudioPluginAudioProcessor::getSoundParameter(const juce::String &parameterID) const
+{
+    const auto *source = apvts.getRawParameterValue(parameterID);
+    auto found = std::lower_bound(presetSources.begin(), presetSources.end(), source,
+                                  [](const PRESET_SOURCE &entry, const std::atomic<float> *s) { return std::less<>()(entry.source, s); });
+
+    if (found == presetSources.end() || found->source != source)
+        return {};
+
+    return {found->source, static_cast<int>(found - presetSources.begin())};
+}
+
+float AudioPluginAudioProcessor::getParameterValue(const SOUND_PARAMETER &parameter) const
+{
+    if (!presetOverride)
+        return parameter->load();
+
+    // The morph starts from the live value, or from the recalled preset until the parameters have caught up
+    const auto slot = static_cast<size_t>(parameter.presetIndex);
+    const auto a = recallPending ? presetA->values[slot] : parameter->load();
+    const auto morph = presetMorph.getCurrentValue();
+
+    if (morph <= 0.0f || presetB == nullptr)
+        return a;
+
+    const auto b = presetB->values[slot];
+
+    if (presetSources[slot].discrete)
+        return morph < 0.5f ? a : b;
+
+    return a + (b - a) * morph;
 }
 
 //==============================================================================
 void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Set up process spec
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    spec.numChannels = static_cast<juce::uint32>(getTotalNumInputChannels());
-
-    // Prepare all DSP modules
-    for (auto *dsp : dspInstances)
     {
-        if (dsp != nullptr)
-            dsp->prepare(spec);
+        const juce::ScopedLock lock(chainBuildLock);
+
+        // Set up process spec
+        spec.sampleRate = sampleRate;
+        spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
+        spec.numChannels = static_cast<juce::uint32>(getTotalNumInputChannels());
+        isPrepared = true;
+        audioActive.store(true, std::memory_order_release);
+
+        startWorkerThreads();
+
+        // Audio is stopped, so the chain for the current order goes straight in
+        delete pendingChain.exchange(nullptr);
+        collectRetiredChains();
+        fadingChain.reset();
+        activeChain = createChain(dspOrder);
+
+        // The audio thread is not reading presets now: free the replaced ones, recompute the coefficients
+        // for the new rate and rebuild the prepared chains for the new spec
+        generalFilterCoefficients.prepare(sampleRate);
+        retiredPresets.clear();
+
+        for (size_t i = 0; i < presets.size(); ++i)
+        {
+            computePresetCoefficients(*presets[i].load(std::memory_order_acquire));
+            delete presetChains[i].exchange(nullptr);
+        }
+
+        refillPresetChains();
+
+        presetA = nullptr;
+        presetB = nullptr;
+        recallPending = false;
+        presetOverride = false;
+        reconfigureAll = false;
+        presetsInUse[0].store(nullptr);
+        presetsInUse[1].store(nullptr);
+
+        // A pending program change survives; so does a recall the message thread has not synced yet, which the
+        // audio thread makes again once it restarts (the preset it pointed to may be freed above)
+        if (recalledPreset.exchange(nullptr) != nullptr)
+        {
+            auto expected = -1;
+            pendingProgram.compare_exchange_strong(expected, currentProgram.load(std::memory_order_relaxed));
+        }
+
+        syncedPreset.store(nullptr);
+        presetChainMissing.store(false);
     }
 
+    chainFadeScratch.setSize(static_cast<int>(spec.numChannels), samplesPerBlock);
+    chainFadeGains.resize(static_cast<size_t>(samplesPerBlock));
+    appliedCrossfadeMs = -1.0f;
+    updateCrossfadeTime();
+    syncChainFades(*activeChain);
+
+    resetSmoothedParameters();
+
+    modulationMatrix.prepare(sampleRate);
+    updateModulationRoutings();
+    applyModulation(0);
+
+#if AUDIO_PLUGIN_PROFILING
+    stageProfiler.prepare(sampleRate);
+#endif
+
+    spectrumAnalyzer.prepare(sampleRate, samplesPerBlock);
+
     // Configure individual DSP modules with default parameters
     configureDSPModules();
+    applyGeneralFilterCoefficients();
+    updateLatency();
+    applyPendingLatency();
+
+    updateTail();
+    silentSamples = 0;
+    wakeTimer();
+}
+
+void AudioPluginAudioProcessor::releaseResources()
+{
+    // The timer finishes what is pending, then stops
+    audioActive.store(false, std::memory_order_release);
+    wakeTimer();
+
+    // Reset all DSP modules
+    if (activeChain != nullptr)
+    {
+        forEachChannelGroup(*activeChain, [](DSP_CHAIN &group)
+        {
+            for (auto &module : group.modules)
+            {
+                if (module != nullptr)
+                    module->reset();
+            }
+        });
+    }
+}
+
+std::unique_ptr<AudioPluginAudioProcessor::DSP_CHAIN> AudioPluginAudioProcessor::createChain(const DSP_ORDER &order) const
+{
+    const auto numChannels = static_cast<size_t>(spec.numChannels);
+    const auto groupSize = getChannelGroupSize();
+
+    auto chain = createChannelGroup(order, 0, juce::jmin(groupSize, numChannels));
+
+    for (auto first = groupSize; first < numChannels; first += groupSize)
+        chain->channelGroups.push_back(createChannelGroup(order, first, juce::jmin(groupSize, numChannels - first)));
+
+    return chain;
+}
+
+size_t AudioPluginAudioProcessor::getChannelGroupSize() const
+{
+    // At most one group per thread, each a whole number of SIMD groups of channels. Groups then start on an
+    // even channel, so the Phaser's and Chorus' left/right LFO offsets land on the same channels as unsplit.
+    constexpr auto alignment = juce::dsp::SIMDRegister<float>::size();
+    const auto numChannels = juce::jmax<size_t>(1, spec.numChannels);
+    const auto numGroups = juce::jmin(static_cast<size_t>(numWorkerThreads) + 1, (numChannels + alignment - 1) / alignment);
+    const auto perGroup = (numChannels + numGroups - 1) / numGroups;
+
+    return (perGroup + alignment - 1) / alignment * alignment;
+}
+
+std::unique_ptr<AudioPluginAudioProcessor::DSP_CHAIN> AudioPluginAudioProcessor::createChannelGroup(const DSP_ORDER &order, size_t firstChannel,
+                                                                                                     size_t numChannels) const
+{
+    auto chain = std::make_unique<DSP_CHAIN>();
+    chain->order = order;
+    chain->firstChannel = firstChannel;
+    chain->numChannels = numChannels;
+
+    if (staticDispatch)
+    {
+        std::array<int, maxChainLength> moduleIndices{};
+
+        for (size_t i = 0; i < order.size(); ++i)
+            moduleIndices[i] = static_cast<int>(order[i]);
+
+        chain->processStatic = StaticModules::getProcessFunction(moduleIndices.data(), order.size());
+    }
+
+    if (chain->processStatic != nullptr)
+    {
+        // Only the modules in the order are prepared; the others are never processed or configured
+        chain->staticModules = std::make_unique<StaticModules>();
+
+        for (size_t i = 0; i < order.size(); ++i)
+            chain->modules[i] = chain->staticModules->getModule<DSP_MODULE>(static_cast<size_t>(order[i]));
+    }
+    else
+    {
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            auto &module = chain->slotModules[i];
+
+            switch (order[i])
+            {
+            case DSP_OPTION::Phase:
+                module = std::make_unique<PhaserModule>();
+                break;
+            case DSP_OPTION::Chorus:
+                module = std::make_unique<ChorusModule>();
+                break;
+            case DSP_OPTION::WaveShaper:
+                module = std::make_unique<WaveShaperModule>();
+                break;
+            case DSP_OPTION::LadderFilter:
+                module = std::make_unique<LadderFilterModule>();
+                break;
+            case DSP_OPTION::GeneralFilter:
+                module = std::make_unique<GeneralFilterModule>();
+                break;
+            default:
+                break;
+            }
+
+            chain->modules[i] = module.get();
+        }
+    }
+
+    auto groupSpec = spec;
+    groupSpec.numChannels = static_cast<juce::uint32>(numChannels);
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (auto *module = chain->modules[i])
+            module->prepare(groupSpec);
+    }
+
+    return chain;
+}
+
+void AudioPluginAudioProcessor::publishChain(std::unique_ptr<DSP_CHAIN> chain)
+{
+    // Called with chainBuildLock held. A chain still pending was never seen by the audio thread, so it can go right away.
+    collectRetiredChains();
+    std::unique_ptr<DSP_CHAIN> replaced(pendingChain.exchange(chain.release(), std::memory_order_acq_rel));
+    wakeTimer(); // to free the outgoing chain once its fade is over
+}
+
+void AudioPluginAudioProcessor::pickUpPendingChain()
+{
+    // One transition at a time: a chain published mid-fade waits for the fade to finish. The outgoing chain
+    // also has to fit into retiredChains eventually; if the message thread is behind on freeing them,
+    // keep the current chain for another block.
+    if (fadingChain != nullptr || retiredChains.getNumAvailableForReading() >= maxRetiredChains)
+        return;
+
+    auto *next = pendingChain.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (next == nullptr)
+        return;
+
+    syncChainFades(*next);
+
+    // The old chain fades out against the new one (with no fade time it is retired on the next sub-block)
+    fadingChain = std::move(activeChain);
+    activeChain.reset(next);
+
+    chainFade.setCurrentAndTargetValue(0.0f);
+    chainFade.setTargetValue(1.0f);
+
+    // The new modules only know their prepare() defaults; bring them up to the current (smoothed) parameters.
+    // This also republishes the General Filter coefficients, which the next sub-block applies.
+    configureDSPModules();
+}
+
+void AudioPluginAudioProcessor::retireFadingChain()
+{
+    // If retiredChains is full, the finished chain is simply held (but no longer processed) until there is room
+    if (fadingChain != nullptr && retiredChains.push(fadingChain.get()))
+        fadingChain.release();
+}
+
+void AudioPluginAudioProcessor::syncChainFades(DSP_CHAIN &chain)
+{
+    // A new chain is faded in as a whole, so its modules start out settled on the current bypass flags
+    const auto seconds = juce::jmax(0.0f, appliedCrossfadeMs) * 0.001;
+
+    forEachChannelGroup(chain, [&](DSP_CHAIN &group)
+    {
+        for (size_t i = 0; i < group.order.size(); ++i)
+        {
+            if (auto *module = group.modules[i])
+            {
+                module->setCrossfadeSeconds(seconds);
+                module->jumpToBypass(isBypassed(group.order[i]));
+            }
+        }
+    });
+}
+
+void AudioPluginAudioProcessor::updateCrossfadeTime()
+{
+    const auto crossfadeMs = processingParams.crossfadeMs->load();
+
+    if (crossfadeMs == appliedCrossfadeMs)
+        return;
+
+    appliedCrossfadeMs = crossfadeMs;
+    const auto seconds = static_cast<double>(crossfadeMs) * 0.001;
+
+    // Changing the time lands any fade in progress on its target
+    chainFade.reset(spec.sampleRate, seconds);
+
+    for (auto *chain : {activeChain.get(), fadingChain.get()})
+    {
+        if (chain == nullptr)
+            continue;
+
+        forEachChannelGroup(*chain, [seconds](DSP_CHAIN &group)
+        {
+            for (auto &module : group.modules)
+            {
+                if (module != nullptr)
+                    module->setCrossfadeSeconds(seconds);
+            }
+        });
+    }
+}
+
+void AudioPluginAudioProcessor::collectRetiredChains()
+{
+    // Called with chainBuildLock held
+    DSP_CHAIN *retired = nullptr;
+
+    while (retiredChains.pull(retired))
+        delete retired;
+}
+
+void AudioPluginAudioProcessor::configurePhaser()
+{
+    const auto numStages = static_cast<int>(getParameterValue(phaserParams.stages));
+    const auto stereoOffset = getParameterValue(phaserParams.stereoSpread) / 360.0; // degrees to cycles
+    auto lowestHz = getSmoothed(FLOAT_PARAM::PhaserCentreFreq);
+
+    forEachModule<PhaserModule>(DSP_OPTION::Phase, [&](StereoPhaser &phaser)
+    {
+        phaser.setRate(getSmoothed(FLOAT_PARAM::PhaserRate));
+        phaser.setDepth(getSmoothed(FLOAT_PARAM::PhaserDepth));
+        phaser.setCentreFrequency(getSmoothed(FLOAT_PARAM::PhaserCentreFreq));
+        phaser.setFeedback(getSmoothed(FLOAT_PARAM::PhaserFeedback));
+        phaser.setMix(getSmoothed(FLOAT_PARAM::PhaserMix));
+        phaser.setNumStages(numStages);
+        phaser.setStereoOffset(stereoOffset);
+        lowestHz = phaser.getLowestFrequency();
+    });
+
+    moduleTailSeconds[static_cast<size_t>(DSP_OPTION::Phase)] =
+        TailEstimate::phaser(lowestHz, numStages, getSmoothed(FLOAT_PARAM::PhaserFeedback));
+}
+
+void AudioPluginAudioProcessor::configureChorus()
+{
+    using Interpolation = MultiVoiceChorus::Interpolation;
+
+    const auto numVoices = static_cast<int>(getParameterValue(chorusParams.voices));
+    const auto stereoOffset = getParameterValue(chorusParams.stereoSpread) / 360.0; // degrees to cycles
+
+    int interpolation = static_cast<int>(getParameterValue(chorusParams.interpolation));
+    if (interpolation < 0 || interpolation >= static_cast<int>(Interpolation::END_OF_LIST))
+        interpolation = static_cast<int>(Interpolation::Linear);
+
+    auto longestDelayMs = getSmoothed(FLOAT_PARAM::ChorusCentreDelay) + MultiVoiceChorus::maxModulationMs;
+
+    forEachModule<ChorusModule>(DSP_OPTION::Chorus, [&](MultiVoiceChorus &chorus)
+    {
+        chorus.setRate(getSmoothed(FLOAT_PARAM::ChorusRate));
+        chorus.setDepth(getSmoothed(FLOAT_PARAM::ChorusDepth));
+        chorus.setCentreDelay(getSmoothed(FLOAT_PARAM::ChorusCentreDelay));
+        chorus.setFeedback(getSmoothed(FLOAT_PARAM::ChorusFeedback));
+        chorus.setMix(getSmoothed(FLOAT_PARAM::ChorusMix));
+        chorus.setNumVoices(numVoices);
+        chorus.setInterpolation(static_cast<Interpolation>(interpolation));
+        chorus.setStereoOffset(stereoOffset);
+        longestDelayMs = chorus.getLongestDelayMs();
+    });
+
+    moduleTailSeconds[static_cast<size_t>(DSP_OPTION::Chorus)] =
+        TailEstimate::chorus(longestDelayMs, getSmoothed(FLOAT_PARAM::ChorusFeedback));
+}
+
+void AudioPluginAudioProcessor::configureWaveShaper()
+{
+    using Curve = WaveShaperStage::Curve;
+
+    const float saturationValue = getSmoothed(FLOAT_PARAM::WaveShaperSaturation);
+    // Scale/normalize the saturation value as needed
+    const float drive = juce::jlimit(1.0f, 20.0f, saturationValue * 0.2f); // Adjust curve if needed
+
+    int curve = static_cast<int>(getParameterValue(waveShaperParams.curve));
+    if (curve < 0 || curve >= static_cast<int>(Curve::END_OF_LIST))
+        curve = static_cast<int>(Curve::Tanh);
+
+    using Stage = OversampledStage<WaveShaperStage>;
+    const auto factor = static_cast<Stage::Factor>(static_cast<int>(getParameterValue(waveShaperParams.oversampling)));
+    const auto filterType = static_cast<Stage::FilterType>(static_cast<int>(getParameterValue(waveShaperParams.oversamplingFilter)));
+
+    int ringingSamples = 0;
+
+    forEachModule<WaveShaperModule>(DSP_OPTION::WaveShaper, [&](Stage &waveShaper)
+    {
+        // Drive is smoothed inside the stage; the curve selects a statically compiled kernel
+        waveShaper.processor.setDrive(drive);
+        waveShaper.processor.setCurve(static_cast<Curve>(curve));
+        waveShaper.setOversampling(factor, filterType);
+        ringingSamples = juce::jmax(ringingSamples, waveShaper.getLatencySamples());
+    });
+
+    // The shaper itself is memoryless; only the resampling filters ring on (for about their latency again)
+    moduleTailSeconds[static_cast<size_t>(DSP_OPTION::WaveShaper)] = ringingSamples / spec.sampleRate;
+}
+
+void AudioPluginAudioProcessor::configureLadderFilter()
+{
+    using Stage = OversampledStage<TieredLadderFilter>;
+    using Quality = TieredLadderFilter::Quality;
+    const auto mode = static_cast<TieredLadderFilter::Mode>(static_cast<int>(getParameterValue(ladderFilterParams.mode)));
+
+    int quality = static_cast<int>(getParameterValue(ladderFilterParams.quality));
+    if (quality < 0 || quality >= static_cast<int>(Quality::END_OF_LIST))
+        quality = static_cast<int>(Quality::Normal);
+
+    const auto factor = static_cast<Stage::Factor>(static_cast<int>(getParameterValue(ladderFilterParams.oversampling)));
+    const auto filterType = static_cast<Stage::FilterType>(static_cast<int>(getParameterValue(ladderFilterParams.oversamplingFilter)));
+
+    int ringingSamples = 0;
+
+    forEachModule<LadderFilterModule>(DSP_OPTION::LadderFilter, [&](Stage &ladderFilter)
+    {
+        auto &ladder = ladderFilter.processor;
+        ladder.setCutoffFrequencyHz(getSmoothed(FLOAT_PARAM::LadderFilterCutoff));
+        ladder.setResonance(getSmoothed(FLOAT_PARAM::LadderFilterResonance));
+        ladder.setDrive(getSmoothed(FLOAT_PARAM::LadderFilterDrive));
+        ladder.setMode(mode);
+        ladder.setQuality(static_cast<Quality>(quality));
+        ladderFilter.setOversampling(factor, filterType);
+        ringingSamples = juce::jmax(ringingSamples, ladderFilter.getLatencySamples());
+    });
+
+    moduleTailSeconds[static_cast<size_t>(DSP_OPTION::LadderFilter)] =
+        TailEstimate::ladder(getSmoothed(FLOAT_PARAM::LadderFilterCutoff), getSmoothed(FLOAT_PARAM::LadderFilterResonance)) +
+        ringingSamples / spec.sampleRate;
+}
+
+void AudioPluginAudioProcessor::configureGeneralFilter()
+{
+    using Mode = BiquadCoefficients::Mode;
+
+    // Mid-morph the filter blends the live (or recalled) coefficients with the target preset's precomputed
+    // ones. Stable biquads form a convex set in (a1, a2), so every blend between two stable filters is stable too.
+    if (presetOverride && presetB != nullptr && presetMorph.getCurrentValue() > 0.0f)
+    {
+        const auto morph = presetMorph.getCurrentValue();
+        BiquadCoefficients blended;
+
+        if (recallPending)
+        {
+            blended = presetA->generalFilterCoefficients;
+        }
+        else
+        {
+            auto liveMode = static_cast<int>(generalFilterParams.mode->load());
+
+            if (liveMode < 0 || liveMode >= static_cast<int>(Mode::END_OF_LIST))
+                liveMode = static_cast<int>(Mode::Peak);
+
+            blended.compute(static_cast<Mode>(liveMode), spec.sampleRate, generalFilterParams.freqHz->load(),
+                            generalFilterParams.quality->load(), generalFilterParams.gainDb->load());
+        }
+
+        for (size_t i = 0; i < blended.raw.size(); ++i)
+            blended.raw[i] += (presetB->generalFilterCoefficients.raw[i] - blended.raw[i]) * morph;
+
+        generalFilterCoefficients.publish(blended);
+        return;
+    }
+
+    int mode = static_cast<int>(getParameterValue(generalFilterParams.mode));
+    float freq = getSmoothed(FLOAT_PARAM::GeneralFilterFreq);
+    float Q = getSmoothed(FLOAT_PARAM::GeneralFilterQuality);
+    float gainDb = getSmoothed(FLOAT_PARAM::GeneralFilterGain);
+
+    if (mode < 0 || mode >= static_cast<int>(Mode::END_OF_LIST))
+        mode = static_cast<int>(Mode::Peak); // fallback
+
+    // Computes into preallocated storage and publishes atomically; no IIR::Coefficients are created here
+    generalFilterCoefficients.update(static_cast<Mode>(mode), freq, Q, gainDb);
+}
+
+void AudioPluginAudioProcessor::applyGeneralFilterCoefficients()
+{
+    // Swap the newest coefficients into every General Filter in the chain
+    if (generalFilterCoefficients.pull(activeGeneralFilterCoefficients))
+    {
+        forEachModule<GeneralFilterModule>(DSP_OPTION::GeneralFilter, [this](MultiChannelBiquad &filter)
+        {
+            filter.setCoefficients(activeGeneralFilterCoefficients);
+        });
+
+        moduleTailSeconds[static_cast<size_t>(DSP_OPTION::GeneralFilter)] =
+            TailEstimate::biquad(activeGeneralFilterCoefficients, spec.sampleRate);
+    }
+}
+
+ChainResponse::Request AudioPluginAudioProcessor::getChainResponseRequest() const
+{
+    using Stage = ChainResponse::Stage;
+    using Mode = BiquadCoefficients::Mode;
+
+    ChainResponse::Request request;
+    request.sampleRate = generalFilterCoefficients.getSampleRate();
+
+    if (request.sampleRate <= 0.0)
+        return request; // nothing to draw until prepareToPlay
+
+    // The host values, which the smoothing and any preset recall on the audio thread settle on
+    for (auto option : dspOrder)
+    {
+        Stage stage;
+
+        if (option == DSP_OPTION::GeneralFilter && generalFilterParams.bypass->load() <= 0.5f)
+        {
+            auto mode = static_cast<int>(generalFilterParams.mode->load());
+
+            if (mode < 0 || mode >= static_cast<int>(Mode::END_OF_LIST))
+                mode = static_cast<int>(Mode::Peak);
+
+            // The same computation configureGeneralFilter() hands to the audio thread
+            stage.type = Stage::Type::Biquad;
+            stage.sampleRate = request.sampleRate;
+            stage.coefficients.compute(static_cast<Mode>(mode), request.sampleRate, generalFilterParams.freqHz->load(),
+                                       generalFilterParams.quality->load(), generalFilterParams.gainDb->load());
+            request.add(stage);
+        }
+        else if (option == DSP_OPTION::LadderFilter && ladderFilterParams.bypass->load() <= 0.5f)
+        {
+            const auto factor = juce::jlimit(0, 3, static_cast<int>(ladderFilterParams.oversampling->load()));
+
+            stage.type = Stage::Type::Ladder;
+            stage.sampleRate = request.sampleRate * static_cast<double>(1 << factor);
+            stage.cutoffHz = ladderFilterParams.cutoffHz->load();
+            stage.resonance = ladderFilterParams.resonance->load();
+            stage.drive = ladderFilterParams.drive->load();
+            stage.mode = static_cast<TieredLadderFilter::Mode>(static_cast<int>(ladderFilterParams.mode->load()));
+            request.add(stage);
+        }
+    }
+
+    return request;
+}
+
+int AudioPluginAudioProcessor::computeLatency()
+{
+    // Oversampled stages keep their latency while bypassed, so only the oversampling settings matter here.
+    // An outgoing chain is only heard for the length of a crossfade, so it does not count. Every channel group
+    // runs the same stages, so the first one stands for them all.
+    int latency = 0;
+
+    forEachModuleInGroup<WaveShaperModule>(activeChain.get(), DSP_OPTION::WaveShaper, [&latency](const auto &stage) { latency += stage.getLatencySamples(); });
+    forEachModuleInGroup<LadderFilterModule>(activeChain.get(), DSP_OPTION::LadderFilter, [&latency](const auto &stage) { latency += stage.getLatencySamples(); });
+
+    return latency;
+}
+
+void AudioPluginAudioProcessor::updateLatency()
+{
+    pendingLatency.store(computeLatency(), std::memory_order_relaxed);
+}
+
+void AudioPluginAudioProcessor::applyPendingLatency()
+{
+    // This only changes when an oversampling option moves; hosts pick up the new value asynchronously
+    const auto latency = pendingLatency.load(std::memory_order_relaxed);
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void AudioPluginAudioProcessor::updateTail()
+{
+    auto seconds = static_cast<double>(pendingLatency.load(std::memory_order_relaxed)) / spec.sampleRate;
+
+    if (activeChain != nullptr)
+    {
+        for (auto option : activeChain->order)
+        {
+            if (!isBypassed(option))
+                seconds += moduleTailSeconds[static_cast<size_t>(option)];
+        }
+    }
+
+    tailSeconds.store(seconds, std::memory_order_relaxed);
+    tailSamples = static_cast<juce::int64>(std::ceil(seconds * spec.sampleRate));
+}
+
+bool AudioPluginAudioProcessor::isSilent(const juce::AudioBuffer<float> &buffer, int numChannels)
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) > silenceThreshold)
+            return false;
+    }
+
+    return true;
+}
+
+void AudioPluginAudioProcessor::timerCallback()
+{
+    applyPendingLatency();
+    syncRecalledPreset();
+
+    // Program changes and renames, for the host and the editor
+    if (programsChanged.exchange(false, std::memory_order_acq_rel))
+        updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+
+    const juce::ScopedLock lock(chainBuildLock);
+
+    // The worker count changed from the host: regroup the chain for it
+    if (startWorkerThreads() && isPrepared)
+        publishChain(createChain(dspOrder));
+
+    collectRetiredChains();
+    collectRetiredPresets();
+    refillPresetChains();
+    updateTimerRate();
+}
+
+void AudioPluginAudioProcessor::wakeTimer()
+{
+    if (getTimerInterval() != 1000 / busyTimerHz)
+        startTimerHz(busyTimerHz);
+}
+
+void AudioPluginAudioProcessor::updateTimerRate()
+{
+    // Called with chainBuildLock held
+    if (hasPendingWork())
+        return;
+
+    if (!audioActive.load(std::memory_order_acquire))
+        stopTimer();
+    else if (getTimerInterval() != 1000 / idleTimerHz)
+        startTimerHz(idleTimerHz);
+}
+
+bool AudioPluginAudioProcessor::hasPendingWork()
+{
+    // Called with chainBuildLock held. Chains and presets retired while audio runs are freed once the audio thread
+    // has moved past them; after releaseResources they wait for the next prepareToPlay, which frees them anyway.
+    if (unappliedProgram.load(std::memory_order_acquire) >= 0 || recalledPreset.load(std::memory_order_acquire) != nullptr ||
+        programsChanged.load(std::memory_order_acquire) || pendingLatency.load(std::memory_order_relaxed) != getLatencySamples())
+        return true;
+
+    return audioActive.load(std::memory_order_acquire) &&
+           (pendingChain.load(std::memory_order_acquire) != nullptr || retiredChains.getNumAvailableForReading() > 0 ||
+            !retiredPresets.empty());
+}
+
+void AudioPluginAudioProcessor::configureDSPModule(DSP_OPTION option)
+{
+    switch (option)
+    {
+    case DSP_OPTION::Phase:
+        configurePhaser();
+        break;
+    case DSP_OPTION::Chorus:
+        configureChorus();
+        break;
+    case DSP_OPTION::WaveShaper:
+        configureWaveShaper();
+        break;
+    case DSP_OPTION::LadderFilter:
+        configureLadderFilter();
+        break;
+    case DSP_OPTION::GeneralFilter:
+        configureGeneralFilter();
+        break;
+    default:
+        break;
+    }
+}
+
+void AudioPluginAudioProcessor::configureDSPModules()
+{
+    // Configure each DSP module with its parameters, regardless of whether they changed
+    for (size_t i = 0; i < moduleListeners.size(); ++i)
+    {
+        appliedVersions[i] = moduleListeners[i].version.load(std::memory_order_acquire);
+        configureDSPModule(static_cast<DSP_OPTION>(i));
+    }
+}
+
+void AudioPluginAudioProcessor::configureChangedDSPModules()
+{
+    // Only reconfigure modules whose parameters moved since they were last configured,
+    // or that still have a parameter ramping towards its target.
+    // The version is sampled before configuring, so a change that lands mid-configure
+    // is picked up on the next sub-block. A preset recall or morph moves everything at once.
+    for (size_t i = 0; i < moduleListeners.size(); ++i)
+    {
+        auto version = moduleListeners[i].version.load(std::memory_order_acquire);
+
+        if (version != appliedVersions[i] || modulesSmoothing[i] || reconfigureAll)
+        {
+            appliedVersions[i] = version;
+            configureDSPModule(static_cast<DSP_OPTION>(i));
+        }
+    }
+
+    reconfigureAll = false;
+}
+
+void AudioPluginAudioProcessor::resetSmoothedParameters()
+{
+    for (size_t i = 0; i < numFloatParams; ++i)
+    {
+        auto &smoothed = smoothedParams[i];
+        smoothed.reset(spec.sampleRate, parameterSmoothingSeconds);
+        smoothed.setCurrentAndTargetValue(getParameterValue(floatParamSources[i]));
+        modulatedValues[i].reset(spec.sampleRate, modulationRampSeconds);
+    }
+
+    presetMorph.reset(spec.sampleRate, parameterSmoothingSeconds);
+    presetMorph.setCurrentAndTargetValue(presetParams.morph->load());
+    modulesSmoothing.fill(false);
+}
+
+void AudioPluginAudioProcessor::advanceSmoothedParameters(int numSamples)
+{
+    // Ramp every float parameter across the coming sub-block and flag the modules that need
+    // reconfiguring. A ramp's final step still flags its module, so it lands exactly on the target.
+    modulesSmoothing.fill(false);
+
+    for (size_t i = 0; i < numFloatParams; ++i)
+    {
+        auto &smoothed = smoothedParams[i];
+        smoothed.setTargetValue(getParameterValue(floatParamSources[i]));
+
+        if (smoothed.isSmoothing())
+        {
+            smoothed.skip(numSamples);
+            modulesSmoothing[static_cast<size_t>(floatParamModules[i])] = true;
+        }
+    }
+}
+
+void AudioPluginAudioProcessor::updateModulationRoutings()
+{
+    // Rebuilt only when a modulation parameter moves (or a preset takes over), never per sub-block
+    appliedModulationVersion = modulationListener.version.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < ModulationMatrix::numLfos; ++i)
+    {
+        auto shape = static_cast<int>(getParameterValue(modulationParams.lfoShape[i]));
+
+        if (shape < 0 || shape >= static_cast<int>(ModulationMatrix::Shape::END_OF_LIST))
+            shape = static_cast<int>(ModulationMatrix::Shape::Sine); // fallback
+
+        modulationMatrix.setLfo(i, getParameterValue(modulationParams.lfoRateHz[i]), static_cast<ModulationMatrix::Shape>(shape));
+    }
+
+    for (size_t i = 0; i < ModulationMatrix::numEnvelopes; ++i)
+    {
+        modulationMatrix.setEnvelope(i, getParameterValue(modulationParams.envelopeAttackMs[i]),
+                                     getParameterValue(modulationParams.envelopeReleaseMs[i]));
+    }
+
+    // Parameters that lose their routing fall back to the plain smoothed value, so their modules need a refresh
+    for (size_t t = 0; t < numModulatedTargets; ++t)
+    {
+        floatParamsModulated[modulatedTargets[t]] = false;
+        modulesSmoothing[static_cast<size_t>(floatParamModules[modulatedTargets[t]])] = true;
+    }
+
+    modulationMatrix.clearRoutings();
+    numModulatedTargets = 0;
+
+    for (size_t i = 0; i < ModulationMatrix::maxRoutings; ++i)
+    {
+        const auto source = static_cast<int>(getParameterValue(modulationParams.slotSource[i])) - 1; // 0 is Off
+        const auto target = static_cast<int>(getParameterValue(modulationParams.slotTarget[i]));
+        const auto depth = getParameterValue(modulationParams.slotAmountPercent[i]) * 0.01f;
+
+        if (source < 0 || source >= static_cast<int>(ModulationMatrix::numSources) ||
+            target < 0 || target >= static_cast<int>(numFloatParams) || depth == 0.0f)
+            continue;
+
+        const auto index = static_cast<size_t>(target);
+        modulationMatrix.addRouting(static_cast<size_t>(source), index, depth);
+
+        if (!floatParamsModulated[index])
+        {
+            floatParamsModulated[index] = true;
+            modulatedTargets[numModulatedTargets++] = index;
+            modulatedValues[index].setCurrentAndTargetValue(smoothedParams[index].getCurrentValue());
+        }
+    }
+}
+
+void AudioPluginAudioProcessor::advanceModulation(const juce::dsp::AudioBlock<float> &input)
+{
+    if (modulationListener.version.load(std::memory_order_acquire) != appliedModulationVersion || reconfigureAll)
+        updateModulationRoutings();
+
+    if (numModulatedTargets == 0)
+        return;
+
+    modulationMatrix.advance(input);
+    applyModulation(static_cast<int>(input.getNumSamples()));
+}
+
+void AudioPluginAudioProcessor::applyModulation(int numSamples)
+{
+    // Sum the routings per parameter in the normalised domain, on top of the smoothed value, ramp towards the
+    // result and flag the modules whose values moved so configureChangedDSPModules() picks them up
+    for (size_t t = 0; t < numModulatedTargets; ++t)
+        modulationOffsets[modulatedTargets[t]] = 0.0f;
+
+    for (size_t r = 0; r < modulationMatrix.getNumRoutings(); ++r)
+    {
+        const auto &routing = modulationMatrix.getRouting(r);
+        modulationOffsets[routing.target] += routing.depth * modulationMatrix.getValue(routing.source);
+    }
+
+    for (size_t t = 0; t < numModulatedTargets; ++t)
+    {
+        const auto index = modulatedTargets[t];
+        const auto &range = floatParamRanges[index];
+        const auto base = range.convertTo0to1(smoothedParams[index].getCurrentValue());
+        const auto value = range.convertFrom0to1(juce::jlimit(0.0f, 1.0f, base + modulationOffsets[index]));
+        auto &modulated = modulatedValues[index];
+
+        if (numSamples == 0)
+        {
+            modulated.setCurrentAndTargetValue(value);
+            continue;
+        }
+
+        modulated.setTargetValue(value);
+
+        if (modulated.isSmoothing())
+        {
+            modulated.skip(numSamples);
+            modulesSmoothing[static_cast<size_t>(floatParamModules[index])] = true;
+        }
+    }
+}
+
+size_t AudioPluginAudioProcessor::getSubBlockSize(size_t hostBlockSize, size_t numChannels) const
+{
+    const auto &sizes = getSubBlockSizes();
+    const auto index = juce::jlimit(0, static_cast<int>(sizes.size()) - 1,
+                                    static_cast<int>(processingParams.subBlockSize->load()));
+    const auto size = sizes[static_cast<size_t>(index)];
+    auto subBlockSize = size > 0 ? static_cast<size_t>(size) : hostBlockSize;
+
+    if (fusedTiling.load(std::memory_order_relaxed))
+        subBlockSize = juce::jmin(subBlockSize, getCacheTileSize(numChannels));
+
+    return juce::jmax<size_t>(1, juce::jmin(subBlockSize, hostBlockSize));
+}
+
+size_t AudioPluginAudioProcessor::getCacheTileSize(size_t numChannels)
+{
+    // The host audio of a tile takes cacheTileBytes; the rest of L1 is left to what the stages touch alongside it
+    // (dry copies for the bypass fades, interleaved and oversampled scratch, the neighbourhood of the delay lines)
+    constexpr size_t minTileSize = 64, maxTileSize = 1024;
+    const auto fit = cacheTileBytes / (juce::jmax<size_t>(1, numChannels) * sizeof(float));
+    auto tileSize = minTileSize;
+
+    while (tileSize * 2 <= juce::jmin(fit, maxTileSize))
+        tileSize *= 2;
+
+    return tileSize;
 }
 
-void AudioPluginAudioProcessor::releaseResources()
+bool AudioPluginAudioProcessor::isControlMoving() const
 {
-    // Reset all DSP modules
-    for (auto *dsp : dspInstances)
+    // Ramps still running from the last sub-block, or a change that will start one
+    if (numModulatedTargets > 0 || recallPending || presetMorph.isSmoothing() ||
+        presetMorph.getTargetValue() != presetParams.morph->load())
+        return true;
+
+    for (size_t i = 0; i < moduleListeners.size(); ++i)
     {
-        if (dsp != nullptr)
-            dsp->reset();
+        if (modulesSmoothing[i] || moduleListeners[i].version.load(std::memory_order_relaxed) != appliedVersions[i])
+            return true;
     }
+
+    return false;
 }
 
-void AudioPluginAudioProcessor::configurePhaser()
+void AudioPluginAudioProcessor::setDSPOrder(const DSP_ORDER &newOrder)
 {
-    phaser.dsp.setRate(*phaserParams.rateHz);
-    phaser.dsp.setDepth(*phaserParams.depthPercent);
-    phaser.dsp.setCentreFrequency(*phaserParams.centerFreqHz);
-    phaser.dsp.setFeedback(*phaserParams.feedbackPercent);
-    phaser.dsp.setMix(*phaserParams.mixPercent);
+    const juce::ScopedLock lock(chainBuildLock);
+
+    if (newOrder == dspOrder)
+        return;
+
+    dspOrder = newOrder;
+
+    // Before the first prepareToPlay there is no spec to build with; prepareToPlay builds the chain then
+    if (isPrepared)
+        publishChain(createChain(newOrder));
 }
 
-void AudioPluginAudioProcessor::configureChorus()
+void AudioPluginAudioProcessor::setWorkerThreads(int numWorkers)
 {
-    chorus.dsp.setRate(*chorusParams.rateHz);
-    chorus.dsp.setDepth(*chorusParams.depthPercent);
-    chorus.dsp.setCentreDelay(*chorusParams.centerDelayMs);
-    chorus.dsp.setFeedback(*chorusParams.feedbackPercent);
-    chorus.dsp.setMix(*chorusParams.mixPercent);
+    auto *parameter = apvts.getParameter(getWorkerThreadsName());
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(static_cast<float>(numWorkers)));
+
+    const juce::ScopedLock lock(chainBuildLock);
+
+    // Prepared preset chains keep the channel groups they were built with; split or not, they sound the same
+    if (startWorkerThreads() && isPrepared)
+        publishChain(createChain(dspOrder));
 }
 
-void AudioPluginAudioProcessor::configureWaveShaper()
+bool AudioPluginAudioProcessor::startWorkerThreads()
 {
-    const float saturationValue = *waveShaperParams.saturation;
-    // Scale/normalize the saturation value as needed
-    const float drive = juce::jlimit(1.0f, 20.0f, saturationValue * 0.2f); // Adjust curve if needed
+    const auto numWorkers = juce::jlimit(0, RealtimeWorkerPool::maxWorkers,
+                                         static_cast<int>(processingParams.workerThreads->load()));
 
-    // Set the shaping function based on drive
-    waveShaper.dsp.functionToUse = [drive](float x)
-    {
-        return std::tanh(drive * x);
-    };
+    if (numWorkers == numWorkerThreads)
+        return false;
+
+    numWorkerThreads = numWorkers;
+    workerPool.start(numWorkers);
+    return true;
 }
 
-void AudioPluginAudioProcessor::configureLadderFilter()
+void AudioPluginAudioProcessor::setParallelThreshold(int channelSamples)
 {
-    ladderFilter.dsp.setCutoffFrequencyHz(*ladderFilterParams.cutoffHz);
-    ladderFilter.dsp.setResonance(*ladderFilterParams.resonance);
-    ladderFilter.dsp.setDrive(*ladderFilterParams.drive);
-    ladderFilter.dsp.setMode(static_cast<juce::dsp::LadderFilter<float>::Mode>(ladderFilterParams.mode->load()));
+    auto *parameter = apvts.getParameter(getParallelThresholdName());
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(static_cast<float>(channelSamples)));
 }
 
-void AudioPluginAudioProcessor::configureGeneralFilter()
+int AudioPluginAudioProcessor::getParallelThreshold() const
 {
-    auto sampleRate = getSampleRate();
-    int mode = generalFilterParams.mode->load();
-    float freq = generalFilterParams.freqHz->load();
-    float Q = generalFilterParams.quality->load();
-    float gainDb = generalFilterParams.gainDb->load();
-    float gainLinear = juce::Decibels::decibelsToGain(gainDb);
-
-    using Coefficients = juce::dsp::IIR::Coefficients<float>;
-
-    switch (mode)
-    {
-    case 0: // Peak
-        generalFilter.dsp.coefficients = Coefficients::makePeakFilter(sampleRate, freq, Q, gainLinear);
-        break;
-    case 1: // Low Pass
-        generalFilter.dsp.coefficients = Coefficients::makeLowPass(sampleRate, freq, Q);
-        break;
-    case 2: // High Pass
-        generalFilter.dsp.coefficients = Coefficients::makeHighPass(sampleRate, freq, Q);
-        break;
-    case 3: // Band Pass
-        generalFilter.dsp.coefficients = Coefficients::makeBandPass(sampleRate, freq, Q);
-        break;
-    case 4: // Notch
-        generalFilter.dsp.coefficients = Coefficients::makeNotch(sampleRate, freq, Q);
-        break;
-    case 5: // All Pass
-        generalFilter.dsp.coefficients = Coefficients::makeAllPass(sampleRate, freq, Q);
-        break;
-    default: // fallback
-        generalFilter.dsp.coefficients = Coefficients::makePeakFilter(sampleRate, freq, Q, gainLinear);
-        break;
-    }
+    return static_cast<int>(processingParams.parallelThreshold->load());
 }
 
-void AudioPluginAudioProcessor::configureDSPModules()
+void AudioPluginAudioProcessor::setStaticDispatch(bool enabled)
 {
-    // Configure each DSP module with its parameters
-    configurePhaser();
-    configureChorus();
-    configureWaveShaper();
-    configureLadderFilter();
-    configureGeneralFilter();
+    const juce::ScopedLock lock(chainBuildLock);
+
+    if (enabled == staticDispatch)
+        return;
 
-    // Notify that the DSP order has changed
-    dspOrderFifo.push(dspOrder);
+    staticDispatch = enabled;
+
+    // Prepared preset chains keep the dispatch they were built with; both paths sound the same
+    if (isPrepared)
+        publishChain(createChain(dspOrder));
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -310,11 +1746,11 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout &layout
     juce::ignoreUnused(layouts);
     return true;
 #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every stage keeps per-channel state and the channels carry no roles, so any layout from mono up to
+    // maxNumChannels works: surround, ambisonics and discrete buses alike
+    const auto mainOutput = layouts.getMainOutputChannelSet();
+
+    if (mainOutput.isDisabled() || mainOutput.size() > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -374,6 +1810,22 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f, 1.f),
         0.3f,
         "%"));
+    // Phaser Stages
+    auto phaserStagesName = getPhaserStagesName();
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(phaserStagesName, versionHint),
+        phaserStagesName,
+        StereoPhaser::minStages,
+        StereoPhaser::maxStages,
+        StereoPhaser::defaultStages));
+    // Phaser Stereo Spread, how far the right channel's sweep runs ahead of the left's
+    auto phaserStereoSpreadName = getPhaserStereoSpreadName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(phaserStereoSpreadName, versionHint),
+        phaserStereoSpreadName,
+        juce::NormalisableRange<float>(0.0f, static_cast<float>(StereoPhaser::maxStereoOffset * 360.0), 1.0f, 1.0f),
+        defaultPhaserStereoSpread,
+        juce::String::fromUTF8("\xc2\xb0")));
     // Phaser Bypass
     auto phaserBypassName = getPhaserBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(
@@ -403,7 +1855,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID(chorusCentreDelayName, versionHint),
         chorusCentreDelayName,
-        juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 1.f),
+        juce::NormalisableRange<float>(0.1f, MultiVoiceChorus::maxCentreDelayMs, 0.1f, 1.f),
         7.0f,
         "ms"));
     // Chorus Feedback
@@ -422,6 +1874,29 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         juce::NormalisableRange<float>(0.f, 1.0f, 0.01f, 1.f),
         0.4f,
         "%"));
+    // Chorus Voices
+    auto chorusVoicesName = getChorusVoicesName();
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(chorusVoicesName, versionHint),
+        chorusVoicesName,
+        1,
+        MultiVoiceChorus::maxVoices,
+        1));
+    // Chorus Interpolation
+    auto chorusInterpolationName = getChorusInterpolationName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(chorusInterpolationName, versionHint),
+        chorusInterpolationName,
+        getChorusInterpolationChoices(),
+        0)); // Default to Linear
+    // Chorus Stereo Spread, how far the right channel's voices run ahead of the left's
+    auto chorusStereoSpreadName = getChorusStereoSpreadName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(chorusStereoSpreadName, versionHint),
+        chorusStereoSpreadName,
+        juce::NormalisableRange<float>(0.0f, static_cast<float>(MultiVoiceChorus::maxStereoOffset * 360.0), 1.0f, 1.0f),
+        defaultChorusStereoSpread,
+        juce::String::fromUTF8("\xc2\xb0")));
     // Chorus Bypass
     auto chorusBypassName = getChorusBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(
@@ -437,6 +1912,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         juce::NormalisableRange<float>(1.f, 100.0f, 0.1f, 1.f),
         1.f,
         ""));
+    // WaveShaper Curve
+    auto waveShaperCurveName = getWaveShaperCurveName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(waveShaperCurveName, versionHint),
+        waveShaperCurveName,
+        getWaveShaperCurveChoices(),
+        0)); // Default to Tanh
+    // WaveShaper Oversampling
+    auto waveShaperOversamplingName = getWaveShaperOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(waveShaperOversamplingName, versionHint),
+        waveShaperOversamplingName,
+        getOversamplingChoices(),
+        0)); // Default to Off
+    auto waveShaperOversamplingFilterName = getWaveShaperOversamplingFilterName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(waveShaperOversamplingFilterName, versionHint),
+        waveShaperOversamplingFilterName,
+        getOversamplingFilterChoices(),
+        0)); // Default to Polyphase IIR
     // WaveShaper Bypass
     auto waveShaperBypassName = getWaveShaperBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(
@@ -476,6 +1971,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         ladderFilterModeName,
         juce::StringArray{"LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24"},
         0)); // Default to LPF12
+    // Ladder Filter Quality
+    auto ladderFilterQualityName = getLadderFilterQualityName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ladderFilterQualityName, versionHint),
+        ladderFilterQualityName,
+        getLadderFilterQualityChoices(),
+        1)); // Default to Normal
+    // Ladder Filter Oversampling
+    auto ladderFilterOversamplingName = getLadderFilterOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ladderFilterOversamplingName, versionHint),
+        ladderFilterOversamplingName,
+        getOversamplingChoices(),
+        0)); // Default to Off
+    auto ladderFilterOversamplingFilterName = getLadderFilterOversamplingFilterName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ladderFilterOversamplingFilterName, versionHint),
+        ladderFilterOversamplingFilterName,
+        getOversamplingFilterChoices(),
+        0)); // Default to Polyphase IIR
     // Ladder Filter Bypass
     auto ladderFilterBypassName = getLadderFilterBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(
@@ -522,6 +2037,109 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         generalFilterBypassName,
         false)); // Default to not bypassed
 
+    // Modulation sources
+    for (size_t i = 0; i < ModulationMatrix::numLfos; ++i)
+    {
+        auto lfoRateName = getModLfoRateName(i);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(lfoRateName, versionHint),
+            lfoRateName,
+            juce::NormalisableRange<float>(0.01f, 20.f, 0.01f, 0.3f),
+            1.f,
+            "Hz"));
+        auto lfoShapeName = getModLfoShapeName(i);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(lfoShapeName, versionHint),
+            lfoShapeName,
+            getModLfoShapeChoices(),
+            0)); // Default to Sine
+    }
+
+    for (size_t i = 0; i < ModulationMatrix::numEnvelopes; ++i)
+    {
+        auto envelopeAttackName = getModEnvelopeAttackName(i);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(envelopeAttackName, versionHint),
+            envelopeAttackName,
+            juce::NormalisableRange<float>(0.1f, 500.f, 0.1f, 0.4f),
+            10.f,
+            "ms"));
+        auto envelopeReleaseName = getModEnvelopeReleaseName(i);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(envelopeReleaseName, versionHint),
+            envelopeReleaseName,
+            juce::NormalisableRange<float>(1.f, 2000.f, 1.f, 0.4f),
+            200.f,
+            "ms"));
+    }
+
+    // Modulation routing slots
+    for (size_t i = 0; i < ModulationMatrix::maxRoutings; ++i)
+    {
+        auto slotSourceName = getModSlotSourceName(i);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(slotSourceName, versionHint),
+            slotSourceName,
+            getModSlotSourceChoices(),
+            0)); // Default to Off
+        auto slotTargetName = getModSlotTargetName(i);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(slotTargetName, versionHint),
+            slotTargetName,
+            getModSlotTargetChoices(),
+            0));
+        auto slotAmountName = getModSlotAmountName(i);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(slotAmountName, versionHint),
+            slotAmountName,
+            juce::NormalisableRange<float>(-100.f, 100.f, 0.1f, 1.f),
+            0.f,
+            "%"));
+    }
+
+    // Processing options
+    auto subBlockSizeName = getSubBlockSizeName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(subBlockSizeName, versionHint),
+        subBlockSizeName,
+        getSubBlockSizeChoices(),
+        1)); // Default to 32 samples
+    auto crossfadeName = getCrossfadeName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(crossfadeName, versionHint),
+        crossfadeName,
+        juce::NormalisableRange<float>(0.f, 500.f, 1.f, 1.f),
+        30.f,
+        "ms"));
+    auto workerThreadsName = getWorkerThreadsName();
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(workerThreadsName, versionHint),
+        workerThreadsName,
+        0,
+        RealtimeWorkerPool::maxWorkers,
+        0)); // Default to processing every channel on the audio thread
+    auto parallelThresholdName = getParallelThresholdName();
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(parallelThresholdName, versionHint),
+        parallelThresholdName,
+        0,
+        maxParallelThreshold,
+        defaultParallelThreshold));
+
+    // Preset options
+    auto presetMorphName = getPresetMorphName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(presetMorphName, versionHint),
+        presetMorphName,
+        juce::NormalisableRange<float>(0.f, 1.f, 0.001f, 1.f),
+        0.f));
+    auto presetMorphTargetName = getPresetMorphTargetName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(presetMorphTargetName, versionHint),
+        presetMorphTargetName,
+        getPresetMorphTargetChoices(),
+        1)); // Default to program 2
+
     return layout;
 }
 
@@ -530,6 +2148,15 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, j
     juce::ignoreUnused(midiMessages);
 
     juce::ScopedNoDenormals noDenormals;
+
+#if AUDIO_PLUGIN_RT_CHECK
+    const RealtimeChecker::ScopedAudioThread realtimeScope; // allocations and locks from here on are violations
+#endif
+
+#if AUDIO_PLUGIN_PROFILING
+    stageProfiler.beginBlock();
+#endif
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -537,55 +2164,239 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, j
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Check if a new DSP order is available
-    DSP_ORDER newOrder;
-    if (dspOrderFifo.pull(newOrder))
+    spectrumAnalyzer.pushInput(buffer);
+
+    // Recall a preset and swap in a new chain if the message thread published either
+    updateCrossfadeTime();
+    pickUpPendingPreset();
+    pickUpPendingChain();
+
+    // Sleep through silence. Once the input has been silent for longer than the chain's tail the output has
+    // died away as well, so the DSP is skipped and the (silent) buffer passes straight through. The first block
+    // with a non-silent sample is processed in full, carrying on from the state the modules were left in.
+    const auto silent = isSilent(buffer, totalNumInputChannels);
+    const auto sleeping = silent && silentSamples >= tailSamples && fadingChain == nullptr;
+    silentSamples = silent ? silentSamples + buffer.getNumSamples() : 0;
+
+    if (!sleeping)
+    {
+        // Split the host buffer into sub-blocks. Parameters are ramped across each sub-block and
+        // the modules are reconfigured at sub-block boundaries, so automation does not step once per host block.
+        // While anything is ramping the sub-blocks are at most maxControlStepSamples long (see isControlMoving).
+        // Each sub-block goes through the whole chain before the next, so with fused tiling capping them at a
+        // cache tile the audio stays in L1 from the first stage to the last; the modules carry their state over.
+        auto audioBlock = juce::dsp::AudioBlock<float>(buffer);
+        const auto numSamples = audioBlock.getNumSamples();
+        const auto groupChannels = activeChain != nullptr ? juce::jmin(activeChain->numChannels, audioBlock.getNumChannels()) : audioBlock.getNumChannels();
+        const auto subBlockSize = getSubBlockSize(numSamples, groupChannels); // a tile per channel group
+
+        for (size_t start = 0, length = 0; start < numSamples; start += length)
+        {
+            length = juce::jmin(subBlockSize, numSamples - start);
+
+            if (isControlMoving())
+                length = juce::jmin(length, maxControlStepSamples);
+
+            advancePresetMorph(static_cast<int>(length));
+            advanceSmoothedParameters(static_cast<int>(length));
+            advanceModulation(audioBlock.getSubBlock(start, length));
+            configureChangedDSPModules(); // Only reconfigure modules whose parameters changed
+            applyGeneralFilterCoefficients();
+
+            processDSPChain(audioBlock.getSubBlock(start, length));
+        }
+    }
+
+    spectrumAnalyzer.pushOutput(buffer);
+
+    updateLatency();
+    updateTail();
+    acknowledgePresets();
+
+#if AUDIO_PLUGIN_PROFILING
+    STAGE_PROFILER::Snapshot timing;
+    if (stageProfiler.endBlock(buffer.getNumSamples(), timing))
+        stageTimingFifo.push(timing); // dropped if the editor is not draining the FIFO
+#endif
+}
+
+bool AudioPluginAudioProcessor::isBypassed(DSP_OPTION option) const
+{
+    switch (option)
+    {
+    case DSP_OPTION::Phase:
+        return getParameterValue(phaserParams.bypass) > 0.5f;
+    case DSP_OPTION::Chorus:
+        return getParameterValue(chorusParams.bypass) > 0.5f;
+    case DSP_OPTION::WaveShaper:
+        return getParameterValue(waveShaperParams.bypass) > 0.5f;
+    case DSP_OPTION::LadderFilter:
+        return getParameterValue(ladderFilterParams.bypass) > 0.5f;
+    case DSP_OPTION::GeneralFilter:
+        return getParameterValue(generalFilterParams.bypass) > 0.5f;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+juce::uint32 AudioPluginAudioProcessor::getBypassMask() const
+{
+    juce::uint32 mask = 0;
+
+    for (size_t i = 0; i < static_cast<size_t>(DSP_OPTION::END_OF_LIST); ++i)
+    {
+        if (isBypassed(static_cast<DSP_OPTION>(i)))
+            mask |= 1u << i;
+    }
+
+    return mask;
+}
+
+void AudioPluginAudioProcessor::processDSPChain(const juce::dsp::AudioBlock<float> &block)
+{
+    if (activeChain == nullptr)
+        return;
+
+    if (fadingChain == nullptr || !chainFade.isSmoothing())
+    {
+        retireFadingChain();
+        processChain(*activeChain, block);
+        return;
+    }
+
+    // Mid-transition: the outgoing chain runs on a copy of the input, then out = old + (new - old) * fade
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(chainFadeScratch.getNumChannels()));
+    const auto n = static_cast<int>(numSamples);
+
+    jassert(numSamples <= chainFadeGains.size());
+
+    auto outgoing = juce::dsp::AudioBlock<float>(chainFadeScratch).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    outgoing.copyFrom(block);
+
+    processChain(*fadingChain, outgoing);
+    processChain(*activeChain, block);
+
+    for (size_t i = 0; i < numSamples; ++i)
+        chainFadeGains[i] = chainFade.getNextValue();
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto *out = block.getChannelPointer(ch);
+        const auto *old = outgoing.getChannelPointer(ch);
+
+        juce::FloatVectorOperations::subtract(out, old, n);
+        juce::FloatVectorOperations::multiply(out, chainFadeGains.data(), n);
+        juce::FloatVectorOperations::add(out, old, n);
+    }
+}
+
+void AudioPluginAudioProcessor::processChain(DSP_CHAIN &chain, const juce::dsp::AudioBlock<float> &block)
+{
+    // Bypassed modules still get the context: they fade out, and oversampled stages keep
+    // running their resampling filters so the reported latency stays constant
+    const auto bypassMask = getBypassMask();
+
+    if (chain.channelGroups.empty())
+    {
+        processChannelGroup(chain, block, bypassMask);
+    }
+    else
+    {
+        // The groups share nothing, so they can run side by side, joining before the next sub-block
+        const auto cost = estimateChainCost(chain, block.getNumSamples() * block.getNumChannels(), bypassMask);
+        const auto threshold = static_cast<size_t>(processingParams.parallelThreshold->load(std::memory_order_relaxed));
+
+        if (workerPool.getNumWorkers() > 0 && cost >= threshold)
+        {
+            CHANNEL_GROUP_JOB job{this, &chain, block, bypassMask};
+            workerPool.run(static_cast<int>(chain.channelGroups.size()) + 1, processChannelGroupTask, &job);
+        }
+        else
+        {
+            forEachChannelGroup(chain, [&](DSP_CHAIN &group) { processChannelGroup(group, block, bypassMask); });
+        }
+    }
+
+#if AUDIO_PLUGIN_PROFILING
+    // Each group timed its stages on whichever thread ran it; after the join they are all back here
+    forEachChannelGroup(chain, [this](DSP_CHAIN &group) { stageProfiler.addStageTicks(group.stageTicks); });
+#endif
+}
+
+void AudioPluginAudioProcessor::processChannelGroupTask(void *job, int groupIndex)
+{
+#if AUDIO_PLUGIN_RT_CHECK
+    const RealtimeChecker::ScopedAudioThread realtimeScope; // the workers are held to the audio thread's rules
+#endif
+
+    auto &groupJob = *static_cast<CHANNEL_GROUP_JOB *>(job);
+    auto &chain = *groupJob.chain;
+    auto &group = groupIndex == 0 ? chain : *chain.channelGroups[static_cast<size_t>(groupIndex - 1)];
+
+    groupJob.processor->processChannelGroup(group, groupJob.block, groupJob.bypassMask);
+}
+
+size_t AudioPluginAudioProcessor::estimateChainCost(const DSP_CHAIN &chain, size_t channelSamples, juce::uint32 bypassMask) const
+{
+    auto getFactor = [this](const SOUND_PARAMETER &oversampling)
+    {
+        return static_cast<size_t>(1) << juce::jlimit(0, 3, static_cast<int>(getParameterValue(oversampling)));
+    };
+
+    // Channel-samples through every active stage, at the rate the stage runs at
+    size_t stages = 0;
+
+    for (auto option : chain.order)
     {
-        dspOrder = newOrder; // Replace the current DSP order
+        if ((bypassMask & (1u << static_cast<juce::uint32>(option))) != 0)
+            continue;
+
+        if (option == DSP_OPTION::WaveShaper)
+            stages += getFactor(waveShaperParams.oversampling);
+        else if (option == DSP_OPTION::LadderFilter)
+            stages += getFactor(ladderFilterParams.oversampling);
+        else
+            ++stages;
     }
 
-    // Create audio block and processing context (create them locally)
-    auto audioBlock = juce::dsp::AudioBlock<float>(buffer);
+    return channelSamples * stages;
+}
+
+void AudioPluginAudioProcessor::processChannelGroup(DSP_CHAIN &group, const juce::dsp::AudioBlock<float> &block, juce::uint32 bypassMask)
+{
+    if (group.firstChannel >= block.getNumChannels())
+        return;
+
+    // Create processing context (create it locally)
+    auto audioBlock = block.getSubsetChannelBlock(group.firstChannel, juce::jmin(group.numChannels, block.getNumChannels() - group.firstChannel));
     auto context = juce::dsp::ProcessContextReplacing<float>(audioBlock);
 
-    configureDSPModules(); // Ensure DSP modules are configured with current parameters
+#if !AUDIO_PLUGIN_PROFILING
+    // The whole order in one call. Profiling builds time every stage, so they always take the per-slot path.
+    if (group.processStatic != nullptr)
+    {
+        group.processStatic(*group.staticModules, context, bypassMask);
+        return;
+    }
+#endif
 
     // Process through DSP chain in specified order
-    for (size_t i = 0; i < dspOrder.size(); ++i)
+    for (size_t i = 0; i < group.order.size(); ++i)
     {
-        auto effectType = dspOrder[i];
-        auto effectIndex = static_cast<size_t>(effectType);
+        auto effectType = group.order[i];
+        auto *module = group.modules[i];
 
-        if (effectIndex < dspInstances.size() && dspInstances[effectIndex] != nullptr)
+        if (module != nullptr)
         {
-            // Check bypass flags before processing
-            bool bypass = false;
-
-            switch (effectType)
-            {
-            case DSP_OPTION::Phase:
-                bypass = phaserParams.bypass && phaserParams.bypass->load();
-                break;
-            case DSP_OPTION::Chorus:
-                bypass = chorusParams.bypass && chorusParams.bypass->load();
-                break;
-            case DSP_OPTION::WaveShaper:
-                bypass = waveShaperParams.bypass && waveShaperParams.bypass->load();
-                break;
-            case DSP_OPTION::LadderFilter:
-                bypass = ladderFilterParams.bypass && ladderFilterParams.bypass->load();
-                break;
-            case DSP_OPTION::GeneralFilter:
-                bypass = generalFilterParams.bypass && generalFilterParams.bypass->load();
-                break;
-            default:
-                break;
-            }
+            context.isBypassed = (bypassMask & (1u << static_cast<juce::uint32>(effectType))) != 0;
 
-            if (!bypass)
-            {
-                dspInstances[effectIndex]->process(context);
-            }
+#if AUDIO_PLUGIN_PROFILING
+            const STAGE_PROFILER::ScopedStage stageTimer(group.stageTicks, static_cast<size_t>(effectType));
+#endif
+            module->process(context);
         }
     }
 }
@@ -593,47 +2404,45 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, j
 //==============================================================================
 bool AudioPluginAudioProcessor::hasEditor() const
 {
+#if AUDIO_PLUGIN_HEADLESS
+    return false;
+#else
     return true; // (change this to false if you choose to not supply an editor)
+#endif
 }
 
 juce::AudioProcessorEditor *AudioPluginAudioProcessor::createEditor()
 {
-    // return new AudioPluginAudioProcessorEditor(*this);
-    return new juce::GenericAudioProcessorEditor(*this); // Use GenericAudioProcessorEditor for simplicity
+#if AUDIO_PLUGIN_HEADLESS
+    return nullptr;
+#else
+    return new AudioPluginAudioProcessorEditor(*this); // Hosts a GenericAudioProcessorEditor for the parameters
+#endif
 }
 
 template <>
 struct juce::VariantConverter<AudioPluginAudioProcessor::DSP_ORDER>
 {
+    // A comma separated list of DSP_OPTION values, one per slot. Any length up to maxChainLength and repeated
+    // options are allowed; an empty string is an empty chain. Invalid entries are skipped.
     static AudioPluginAudioProcessor::DSP_ORDER fromVar(const juce::var &v)
     {
+        using DSP_OPTION = AudioPluginAudioProcessor::DSP_OPTION;
+
         AudioPluginAudioProcessor::DSP_ORDER order;
-        juce::String orderString = v.toString();
+        juce::StringArray tokens = juce::StringArray::fromTokens(v.toString(), ",", "");
 
-        if (orderString.isNotEmpty())
+        for (const auto &token : tokens)
         {
-            juce::StringArray tokens = juce::StringArray::fromTokens(orderString, ",", "");
+            if (token.trim().isEmpty() || !token.trim().containsOnly("0123456789"))
+                continue;
 
-            for (size_t i = 0; i < order.size() && i < static_cast<size_t>(tokens.size()); ++i)
-            {
-                int enumValue = tokens[static_cast<int>(i)].getIntValue();
-
-                if (enumValue >= 0 && enumValue < static_cast<int>(AudioPluginAudioProcessor::DSP_OPTION::END_OF_LIST))
-                {
-                    order[i] = static_cast<AudioPluginAudioProcessor::DSP_OPTION>(enumValue);
-                }
-                else
-                {
-                    order[i] = static_cast<AudioPluginAudioProcessor::DSP_OPTION>(i);
-                }
-            }
-        }
-        else
-        {
-            // Default order
-            for (size_t i = 0; i < order.size(); ++i)
+            int enumValue = token.getIntValue();
+
+            if (enumValue >= 0 && enumValue < static_cast<int>(DSP_OPTION::END_OF_LIST))
             {
-                order[i] = static_cast<AudioPluginAudioProcessor::DSP_OPTION>(i);
+                if (!order.push_back(static_cast<DSP_OPTION>(enumValue)))
+                    break;
             }
         }
 
@@ -658,25 +2467,189 @@ struct juce::VariantConverter<AudioPluginAudioProcessor::DSP_ORDER>
 //==============================================================================
 void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-    // Copy the current state from the APVTS
-    auto state = apvts.copyState();
+    writeBinaryState(destData);
+}
+
+void AudioPluginAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
+{
+    // Blobs without the magic are XML, as saved before the binary format existed
+    if (!readBinaryState(data, sizeInBytes))
+        readXmlState(data, sizeInBytes);
+
+    wakeTimer(); // to report the restored program and latency
+}
+
+void AudioPluginAudioProcessor::writeBinaryState(juce::MemoryBlock &destData)
+{
+    destData.reset();
+    juce::MemoryOutputStream stream(destData, false);
+
+    stream.write(binaryStateMagic, sizeof(binaryStateMagic));
+    stream.writeShort(static_cast<short>(binaryStateVersion));
+
+    stream.writeByte(static_cast<char>(dspOrder.size()));
+
+    for (auto option : dspOrder)
+        stream.writeByte(static_cast<char>(option));
+
+    stream.writeShort(static_cast<short>(parametersByHash.size()));
+
+    for (const auto &[hash, parameter] : parametersByHash)
+    {
+        stream.writeInt(static_cast<int>(hash));
+        stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+    }
+
+    // Program bank
+    stream.writeShort(static_cast<short>(currentProgram.load(std::memory_order_relaxed)));
+    stream.writeShort(static_cast<short>(numPresets));
+
+    for (const auto &slot : presets)
+    {
+        const auto &preset = *slot.load(std::memory_order_acquire);
+
+        stream.writeString(preset.name);
+        stream.writeByte(static_cast<char>(preset.order.size()));
+
+        for (auto option : preset.order)
+            stream.writeByte(static_cast<char>(option));
+
+        stream.writeShort(static_cast<short>(presetSources.size()));
+
+        for (size_t i = 0; i < presetSources.size(); ++i)
+        {
+            stream.writeInt(static_cast<int>(presetSources[i].hash));
+            stream.writeFloat(preset.values[i]);
+        }
+    }
+}
+
+bool AudioPluginAudioProcessor::readBinaryState(const void *data, int sizeInBytes)
+{
+    constexpr int headerSize = static_cast<int>(sizeof(binaryStateMagic)) + 2;
+
+    if (data == nullptr || sizeInBytes < headerSize || std::memcmp(data, binaryStateMagic, sizeof(binaryStateMagic)) != 0)
+        return false;
+
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    stream.skipNextBytes(sizeof(binaryStateMagic));
+
+    // A newer layout may mean anything; ignore it rather than misread it (the magic still marks it as not XML)
+    const auto version = static_cast<int>(stream.readShort());
+
+    if (version < 1 || version > binaryStateVersion)
+        return true;
+
+    // Order
+    if (stream.getNumBytesRemaining() < 1)
+        return true;
+
+    const auto orderLength = static_cast<juce::uint8>(stream.readByte());
+
+    if (stream.getNumBytesRemaining() < orderLength)
+        return true;
+
+    DSP_ORDER restoredOrder;
+
+    for (int i = 0; i < orderLength; ++i)
+    {
+        const auto option = static_cast<juce::uint8>(stream.readByte());
+
+        if (option < static_cast<juce::uint8>(DSP_OPTION::END_OF_LIST))
+            restoredOrder.push_back(static_cast<DSP_OPTION>(option));
+    }
+
+    setDSPOrder(restoredOrder);
+
+    // Sessions from before the stereo spreads existed swept both channels together
+    setParameterToLegacyValue(apvts, getPhaserStereoSpreadName(), legacyPhaserStereoSpread);
+    setParameterToLegacyValue(apvts, getChorusStereoSpreadName(), legacyChorusStereoSpread);
+
+    // Parameters; unknown hashes are skipped, and parameters missing from the blob keep their values
+    if (stream.getNumBytesRemaining() < 2)
+        return true;
+
+    const auto numParameters = static_cast<juce::uint16>(stream.readShort());
+
+    for (int i = 0; i < numParameters && stream.getNumBytesRemaining() >= 8; ++i)
+    {
+        const auto hash = static_cast<juce::uint32>(stream.readInt());
+        const auto value = stream.readFloat();
+
+        auto found = std::lower_bound(parametersByHash.begin(), parametersByHash.end(), hash,
+                                      [](const auto &entry, juce::uint32 h) { return entry.first < h; });
+
+        if (found != parametersByHash.end() && found->first == hash)
+            found->second->setValueNotifyingHost(found->second->convertTo0to1(value));
+    }
+
+    // Program bank. Older blobs leave the bank as it is.
+    if (version < 2 || stream.getNumBytesRemaining() < 4)
+        return true;
+
+    const auto program = static_cast<int>(static_cast<juce::uint16>(stream.readShort()));
+    const auto numStoredPresets = static_cast<int>(static_cast<juce::uint16>(stream.readShort()));
+
+    for (int i = 0; i < juce::jmin(numStoredPresets, numPresets) && !stream.isExhausted(); ++i)
+    {
+        if (auto preset = readPreset(stream))
+            replacePreset(i, std::move(preset));
+    }
+
+    // The parameters above already hold the program's sound, so there is nothing to recall
+    if (program < numPresets)
+    {
+        currentProgram.store(program, std::memory_order_relaxed);
+        programsChanged.store(true, std::memory_order_release);
+    }
+
+    return true;
+}
+
+std::unique_ptr<AudioPluginAudioProcessor::PRESET> AudioPluginAudioProcessor::readPreset(juce::InputStream &stream) const
+{
+    // Sound parameters missing from the blob take their defaults
+    auto preset = std::make_unique<PRESET>();
+    preset->name = stream.readString();
+
+    for (const auto &source : presetSources)
+        preset->values.push_back(source.parameter->convertFrom0to1(source.parameter->getDefaultValue()));
+
+    const auto orderLength = static_cast<juce::uint8>(stream.readByte());
+
+    if (stream.getNumBytesRemaining() < orderLength + 2)
+        return nullptr;
+
+    for (int i = 0; i < orderLength; ++i)
+    {
+        const auto option = static_cast<juce::uint8>(stream.readByte());
+
+        if (option < static_cast<juce::uint8>(DSP_OPTION::END_OF_LIST))
+            preset->order.push_back(static_cast<DSP_OPTION>(option));
+    }
+
+    const auto numValues = static_cast<juce::uint16>(stream.readShort());
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        if (stream.getNumBytesRemaining() < 8)
+            return nullptr;
 
-    // Serialize DSP order using VariantConverter
-    auto dspOrderVar = juce::VariantConverter<DSP_ORDER>::toVar(dspOrder);
-    state.setProperty("dspOrder", dspOrderVar, nullptr);
+        const auto hash = static_cast<juce::uint32>(stream.readInt());
+        const auto value = stream.readFloat();
 
-    // Convert to XML and store it
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+        auto found = std::find_if(presetSources.begin(), presetSources.end(),
+                                  [hash](const PRESET_SOURCE &source) { return source.hash == hash; });
 
-    // Optionally write the XML to a file for debugging purposes
-    // xml->writeToFile(juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
-    //              .getChildFile("PluginStateDump.xml"), {});
+        if (found != presetSources.end())
+            preset->values[static_cast<size_t>(found - presetSources.begin())] = value;
+    }
 
-    if (xml != nullptr)
-        copyXmlToBinary(*xml, destData);
+    computePresetCoefficients(*preset);
+    return preset;
 }
 
-void AudioPluginAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
+void AudioPluginAudioProcessor::readXmlState(const void *data, int sizeInBytes)
 {
     // Load the XML from the binary block
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
@@ -692,11 +2665,18 @@ void AudioPluginAudioProcessor::setStateInformation(const void *data, int sizeIn
             if (tree.hasProperty("dspOrder"))
             {
                 DSP_ORDER restoredOrder = juce::VariantConverter<DSP_ORDER>::fromVar(tree.getProperty("dspOrder"));
-                dspOrderFifo.push(restoredOrder); // Apply restored DSP order
+                setDSPOrder(restoredOrder); // Apply restored DSP order
             }
 
-            // Apply the parameter state
+            // Apply the parameter state. Parameters missing from the tree take their defaults, except the ones
+            // whose default would change how an older session sounds.
             apvts.replaceState(tree);
+
+            if (!tree.getChildWithProperty("id", getPhaserStereoSpreadName()).isValid())
+                setParameterToLegacyValue(apvts, getPhaserStereoSpreadName(), legacyPhaserStereoSpread);
+
+            if (!tree.getChildWithProperty("id", getChorusStereoSpreadName()).isValid())
+                setParameterToLegacyValue(apvts, getChorusStereoSpreadName(), legacyChorusStereoSpread);
         }
     }
 }
@@ -9,12 +9,39 @@
 #pragma once
 
 #include <JuceHeader.h>
+
+// Set to 1 by console targets (Tools/) that build the processor without its editor
+#ifndef AUDIO_PLUGIN_HEADLESS
+ #define AUDIO_PLUGIN_HEADLESS 0
+#endif
+
+// Before the class, which depends on JucePlugin_PreferredChannelConfigurations. Console targets get the
+// stand-in from Tools/Common.
+#include <JucePluginDefines.h>
+
 #include <Fifo.h>
+#include "DSP/BiquadCoefficients.h"
+#include "DSP/MultiChannelBiquad.h"
+#include "DSP/Saturator.h"
+#include "DSP/OversampledStage.h"
+#include "DSP/StereoPhaser.h"
+#include "DSP/MultiVoiceChorus.h"
+#include "DSP/TieredLadderFilter.h"
+#include "DSP/StaticChain.h"
+#include "DSP/BypassCrossfade.h"
+#include "DSP/TailEstimate.h"
+#include "DSP/ModulationMatrix.h"
+#include "DSP/StageProfiler.h"
+#include "DSP/SpectrumAnalyzer.h"
+#include "DSP/ChainResponse.h"
+#include "DSP/RealtimeChecker.h"
+#include "DSP/RealtimeWorkerPool.h"
 
 //==============================================================================
 /**
 */
-class AudioPluginAudioProcessor  : public juce::AudioProcessor
+class AudioPluginAudioProcessor  : public juce::AudioProcessor,
+                                   private juce::Timer
 {
 public:
     //==============================================================================
@@ -65,92 +92,398 @@ public:
         END_OF_LIST
     };
 
+    // Continuous parameters, smoothed per sub-block before they reach the modules
+    enum class FLOAT_PARAM
+    {
+        PhaserRate,
+        PhaserDepth,
+        PhaserCentreFreq,
+        PhaserFeedback,
+        PhaserMix,
+        ChorusRate,
+        ChorusDepth,
+        ChorusCentreDelay,
+        ChorusFeedback,
+        ChorusMix,
+        WaveShaperSaturation,
+        LadderFilterCutoff,
+        LadderFilterResonance,
+        LadderFilterDrive,
+        GeneralFilterFreq,
+        GeneralFilterQuality,
+        GeneralFilterGain,
+        END_OF_LIST
+    };
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts;
 
-    using DSP_ORDER = std::array<DSP_OPTION, static_cast<size_t>(DSP_OPTION::END_OF_LIST)>;
-    using DSP_POINTERS = std::array<juce::dsp::ProcessorBase*, static_cast<size_t>(DSP_OPTION::END_OF_LIST)>;
+    // Widest bus: any layout up to this many channels (mono, stereo, surround, ambisonic, discrete), the same on both sides
+    static constexpr int maxNumChannels = 16;
+
+    // Longest processing chain
+    static constexpr size_t maxChainLength = 8;
+
+    // Processing order: anything from an empty chain up to maxChainLength modules, repeats allowed
+    struct DSP_ORDER
+    {
+        DSP_ORDER() = default;
+
+        DSP_ORDER(std::initializer_list<DSP_OPTION> options)
+        {
+            for (auto option : options)
+                push_back(option);
+        }
+
+        size_t size() const noexcept { return length; }
+        bool empty() const noexcept { return length == 0; }
+        static constexpr size_t capacity() noexcept { return maxChainLength; }
+
+        // Returns false (and leaves the order unchanged) when the chain is already full
+        bool push_back(DSP_OPTION option) noexcept
+        {
+            if (length == maxChainLength)
+                return false;
+
+            slots[length++] = option;
+            return true;
+        }
+
+        void clear() noexcept { length = 0; }
+
+        DSP_OPTION& operator[](size_t index) noexcept { jassert(index < length); return slots[index]; }
+        const DSP_OPTION& operator[](size_t index) const noexcept { jassert(index < length); return slots[index]; }
+
+        DSP_OPTION* begin() noexcept { return slots.data(); }
+        DSP_OPTION* end() noexcept { return slots.data() + length; }
+        const DSP_OPTION* begin() const noexcept { return slots.data(); }
+        const DSP_OPTION* end() const noexcept { return slots.data() + length; }
+
+        bool operator==(const DSP_ORDER& other) const noexcept { return std::equal(begin(), end(), other.begin(), other.end()); }
+        bool operator!=(const DSP_ORDER& other) const noexcept { return !(*this == other); }
 
+    private:
+        std::array<DSP_OPTION, maxChainLength> slots{};
+        size_t length = 0;
+    };
+
+    // The most recently requested order (which the audio thread picks up shortly after)
     const DSP_ORDER& getDSPOrder() const { return dspOrder; }
 
+    // Builds and prepares a chain for the new order on the calling thread and hands it to the
+    // audio thread. Does nothing if the order did not change. Never call from the audio thread.
+    void setDSPOrder(const DSP_ORDER& newOrder);
+
+    // Orders that use each module at most once run through a compile-time specialised chain (see StaticChain);
+    // disabling it puts every order on the per-slot DSP_CHOICE path. Rebuilds the chain like setDSPOrder.
+    void setStaticDispatch(bool enabled);
+    bool isStaticDispatchEnabled() const { return staticDispatch; }
+
+    // With fused tiling on, no sub-block is longer than a cache tile (see getCacheTileSize), so a large host
+    // block runs through the whole chain a tile at a time instead of passing over the buffer once per stage.
+    // Off, "Host Block" processes every stage on the whole buffer. Safe to call from any thread.
+    void setFusedTiling(bool enabled) { fusedTiling.store(enabled); }
+    bool isFusedTilingEnabled() const { return fusedTiling.load(); }
+
+    // Channel-parallel processing, set by the "Processing Worker Threads" parameter. With worker threads,
+    // chains are built as channel groups (whole SIMD groups of channels, at most one per thread) and each
+    // sub-block runs its groups on a RealtimeWorkerPool alongside the audio thread, joining before the next.
+    // Sets the parameter and rebuilds the chain like setDSPOrder; 0 (the default) goes back to one group.
+    // Changes made by the host are picked up by the timer. Never call from the audio thread.
+    void setWorkerThreads(int numWorkers);
+    int getWorkerThreads() const { return numWorkerThreads; }
+
+    // Sub-blocks that cost less than the "Processing Parallel Threshold" parameter run their channel groups one
+    // after another on the audio thread. The cost is in channel-samples through a stage, with oversampled
+    // stages counting their factor, so the default is 16 channels of 256 samples through four stages.
+    static constexpr int defaultParallelThreshold = 16384;
+    static constexpr int maxParallelThreshold = 1 << 20;
+    void setParallelThreshold(int channelSamples);
+    int getParallelThreshold() const;
+
+    // A sound parameter's live value and its slot in presetSources (and so in every PRESET::values),
+    // looked up once in the constructor so the audio thread never searches for it
+    struct SOUND_PARAMETER
+    {
+        std::atomic<float>* value = nullptr;
+        int presetIndex = -1;
 
-    SimpleMBComp::Fifo<DSP_ORDER> dspOrderFifo;
+        std::atomic<float>* operator->() const noexcept { return value; }
+        explicit operator bool() const noexcept { return value != nullptr && presetIndex >= 0; }
+    };
 
     // Parameters for Phaser
     struct PhaserParams {
-        std::atomic<float>* rateHz = nullptr;
-        std::atomic<float>* depthPercent = nullptr;
-        std::atomic<float>* centerFreqHz = nullptr;
-        std::atomic<float>* feedbackPercent = nullptr;
-        std::atomic<float>* mixPercent = nullptr;
-        std::atomic<bool>* bypass = nullptr;
+        SOUND_PARAMETER rateHz;
+        SOUND_PARAMETER depthPercent;
+        SOUND_PARAMETER centerFreqHz;
+        SOUND_PARAMETER feedbackPercent;
+        SOUND_PARAMETER mixPercent;
+        SOUND_PARAMETER stages; // Int parameter, 4 to 12 allpass stages
+        SOUND_PARAMETER stereoSpread; // degrees the odd channels' sweep runs ahead, 0 in old sessions
+        SOUND_PARAMETER bypass; // Bool parameter, stored as 0/1 float
     };
 
     PhaserParams phaserParams;
 
     // Parmeters for Chorus
     struct ChorusParams {
-        std::atomic<float>* rateHz = nullptr;
-        std::atomic<float>* depthPercent = nullptr;
-        std::atomic<float>* centerDelayMs = nullptr;
-        std::atomic<float>* feedbackPercent = nullptr;
-        std::atomic<float>* mixPercent = nullptr;
-        std::atomic<bool>* bypass = nullptr;
+        SOUND_PARAMETER rateHz;
+        SOUND_PARAMETER depthPercent;
+        SOUND_PARAMETER centerDelayMs;
+        SOUND_PARAMETER feedbackPercent;
+        SOUND_PARAMETER mixPercent;
+        SOUND_PARAMETER voices; // Int parameter, 1 to 8 voices
+        SOUND_PARAMETER interpolation; // Choice index
+        SOUND_PARAMETER stereoSpread; // degrees the odd channels' voices run ahead, 0 in old sessions
+        SOUND_PARAMETER bypass; // Bool parameter, stored as 0/1 float
     };
     ChorusParams chorusParams;
 
     // Parameters for Wave Shaper
     struct WaveShaperParams {
-        std::atomic<float>* saturation = nullptr;
-        std::atomic<bool>* bypass = nullptr;
+        SOUND_PARAMETER saturation;
+        SOUND_PARAMETER curve; // Choice index, stored as float by the APVTS
+        SOUND_PARAMETER oversampling; // Choice index
+        SOUND_PARAMETER oversamplingFilter; // Choice index
+        SOUND_PARAMETER bypass; // Bool parameter, stored as 0/1 float
     };
     WaveShaperParams waveShaperParams;
 
 
     // Parameters for Ladder Filter
     struct LadderFilterParams {
-        std::atomic<float>* cutoffHz = nullptr;
-        std::atomic<float>* resonance = nullptr;
-        std::atomic<float>* drive = nullptr;
-        std::atomic<int>* mode = nullptr; // Mode is enum-backed, so int works
-        std::atomic<bool>* bypass = nullptr;
+        SOUND_PARAMETER cutoffHz;
+        SOUND_PARAMETER resonance;
+        SOUND_PARAMETER drive;
+        SOUND_PARAMETER mode; // Choice index, stored as float by the APVTS
+        SOUND_PARAMETER quality; // Choice index
+        SOUND_PARAMETER oversampling; // Choice index
+        SOUND_PARAMETER oversamplingFilter; // Choice index
+        SOUND_PARAMETER bypass; // Bool parameter, stored as 0/1 float
     };
 
     LadderFilterParams ladderFilterParams;
 
     // Parameters for General Filter
     struct GeneralFilterParams {
-        std::atomic<int>* mode = nullptr; // Mode is enum-backed, so int works
-        std::atomic<float>* freqHz = nullptr;
-        std::atomic<float>* quality = nullptr;
-        std::atomic<float>* gainDb = nullptr;
-        std::atomic<bool>* bypass = nullptr;
+        SOUND_PARAMETER mode; // Choice index, stored as float by the APVTS
+        SOUND_PARAMETER freqHz;
+        SOUND_PARAMETER quality;
+        SOUND_PARAMETER gainDb;
+        SOUND_PARAMETER bypass; // Bool parameter, stored as 0/1 float
     };
     GeneralFilterParams generalFilterParams;
 
+    // Modulation sources and routing slots
+    struct ModulationParams {
+        std::array<SOUND_PARAMETER, ModulationMatrix::numLfos> lfoRateHz{};
+        std::array<SOUND_PARAMETER, ModulationMatrix::numLfos> lfoShape{}; // Choice index into ModulationMatrix::Shape
+        std::array<SOUND_PARAMETER, ModulationMatrix::numEnvelopes> envelopeAttackMs{};
+        std::array<SOUND_PARAMETER, ModulationMatrix::numEnvelopes> envelopeReleaseMs{};
+        std::array<SOUND_PARAMETER, ModulationMatrix::maxRoutings> slotSource{}; // Choice index: Off, then the sources
+        std::array<SOUND_PARAMETER, ModulationMatrix::maxRoutings> slotTarget{}; // Choice index into FLOAT_PARAM
+        std::array<SOUND_PARAMETER, ModulationMatrix::maxRoutings> slotAmountPercent{};
+    };
+    ModulationParams modulationParams;
+
+    // Preset options
+    struct PresetParams {
+        std::atomic<float>* morph = nullptr; // 0 = the current program, 1 = the morph target
+        std::atomic<float>* morphTarget = nullptr; // Choice index: program to morph towards
+    };
+    PresetParams presetParams;
+
+    // Preset bank, exposed through the program API. Each preset is an immutable snapshot of the sound
+    // parameters, the order and the General Filter coefficients; setCurrentProgram() only hands an index
+    // to the audio thread, so it is safe to call from any thread. The bank is saved with the plugin state.
+    static constexpr int numPresets = 8;
+
+    // Captures the current parameters and order into a program slot. Message thread only.
+    void storePreset(int index);
+
+    // Processing options
+    struct ProcessingParams {
+        std::atomic<float>* subBlockSize = nullptr; // Choice index into getSubBlockSizes()
+        std::atomic<float>* crossfadeMs = nullptr; // Fade time for bypass changes and chain swaps
+        std::atomic<float>* workerThreads = nullptr; // See setWorkerThreads()
+        std::atomic<float>* parallelThreshold = nullptr; // See setParallelThreshold()
+    };
+    ProcessingParams processingParams;
+
+    // Sub-block sizes offered by the "Processing Sub Block" parameter; 0 means the whole host block
+    static const std::array<int, 6>& getSubBlockSizes();
+
+    // Longest run of samples that keeps a tile of numChannels of audio within cacheTileBytes, as a power of two
+    static constexpr size_t cacheTileBytes = 4096;
+    static size_t getCacheTileSize(size_t numChannels);
+
+    // Input and output spectra for the editor. processBlock hands it every block; it does nothing until an
+    // editor registers with addClient().
+    SpectrumAnalyzer spectrumAnalyzer;
+
+    // Response of the linear stages (General Filter, Ladder Filter) in the requested order, for the editor.
+    // Editors poll with getChainResponseRequest(); ChainResponse drops requests that did not change.
+    ChainResponse chainResponse;
+    static_assert(ChainResponse::maxStages >= maxChainLength);
+
+    // Describes the non-bypassed linear stages from the current parameter values. Message thread.
+    ChainResponse::Request getChainResponseRequest() const;
+
+#if AUDIO_PLUGIN_PROFILING
+    // Per-stage timing (indexed by DSP_OPTION), published to the editor about ten times a second
+    using STAGE_PROFILER = StageProfiler<static_cast<size_t>(DSP_OPTION::END_OF_LIST)>;
+    SimpleMBComp::Fifo<STAGE_PROFILER::Snapshot> stageTimingFifo;
+#endif
+
 private:
+    // Bumps a per-module version counter whenever one of the module's parameters moves,
+    // so processBlock only reconfigures the modules that actually changed.
+    struct ModuleChangeListener : juce::AudioProcessorValueTreeState::Listener
+    {
+        void parameterChanged(const juce::String&, float) override
+        {
+            version.fetch_add(1, std::memory_order_release);
+        }
+
+        std::atomic<juce::uint32> version{1};
+    };
+
+    using MODULE_LISTENERS = std::array<ModuleChangeListener, static_cast<size_t>(DSP_OPTION::END_OF_LIST)>;
+    using MODULE_VERSIONS = std::array<juce::uint32, static_cast<size_t>(DSP_OPTION::END_OF_LIST)>;
+
+    MODULE_LISTENERS moduleListeners;
+    MODULE_VERSIONS appliedVersions{};
+
+    // Per-sub-block parameter smoothing
+    static constexpr size_t numFloatParams = static_cast<size_t>(FLOAT_PARAM::END_OF_LIST);
+    static constexpr double parameterSmoothingSeconds = 0.05;
+
+    std::array<SOUND_PARAMETER, numFloatParams> floatParamSources{};
+    std::array<DSP_OPTION, numFloatParams> floatParamModules{};
+    std::array<juce::SmoothedValue<float>, numFloatParams> smoothedParams;
+    std::array<bool, static_cast<size_t>(DSP_OPTION::END_OF_LIST)> modulesSmoothing{};
+
+    // Modulation, stepped per sub-block and added on top of the smoothed values. The sum ramps to each new
+    // value over modulationRampSeconds like any other smoothed parameter, so sources that move every
+    // sub-block do not step. Only routed parameters are touched, so the cost follows the number of routings.
+    static constexpr double modulationRampSeconds = 0.005;
+
+    ModulationMatrix modulationMatrix;
+    ModuleChangeListener modulationListener;
+    juce::uint32 appliedModulationVersion = 0;
+    std::array<juce::NormalisableRange<float>, numFloatParams> floatParamRanges;
+    std::array<juce::SmoothedValue<float>, numFloatParams> modulatedValues;
+    std::array<bool, numFloatParams> floatParamsModulated{};
+    std::array<float, numFloatParams> modulationOffsets{}; // normalised, only valid for routed parameters
+    std::array<size_t, ModulationMatrix::maxRoutings> modulatedTargets{}; // each routed parameter once
+    size_t numModulatedTargets = 0;
+
+    void updateModulationRoutings();
+    void advanceModulation(const juce::dsp::AudioBlock<float>& input);
+    void applyModulation(int numSamples); // 0 jumps straight to the modulated values
+
+    float getSmoothed(FLOAT_PARAM param) const
+    {
+        const auto index = static_cast<size_t>(param);
+        return floatParamsModulated[index] ? modulatedValues[index].getCurrentValue() : smoothedParams[index].getCurrentValue();
+    }
+    void resetSmoothedParameters();
+    void advanceSmoothedParameters(int numSamples);
+    size_t getSubBlockSize(size_t hostBlockSize, size_t numChannels) const;
+
+    // Smoothed and modulated values step once per sub-block. While any of them moves, sub-blocks are capped at
+    // maxControlStepSamples whatever the sub-block option says, so a large "Host Block" never turns a ramp
+    // into a few audible steps; settled parameters go back to the full sub-block size.
+    static constexpr size_t maxControlStepSamples = 32;
+    bool isControlMoving() const;
+
     void configurePhaser();
     void configureChorus();
     void configureWaveShaper();
     void configureLadderFilter();
     void configureGeneralFilter();
+    void applyGeneralFilterCoefficients();
+
+    // The audio thread only records the latency; the message thread reports it to the host,
+    // since setLatencySamples() notifies listeners under a lock.
+    int computeLatency();
+    void updateLatency();
+    void applyPendingLatency();
+    void timerCallback() override;
+    std::atomic<int> pendingLatency{0};
+
+    // The timer does the message thread's share of the work: latency, program changes, freeing retired chains and
+    // presets, and worker counts changed by the host. It runs at busyTimerHz while any of that is pending, at
+    // idleTimerHz while audio runs (the audio thread queues work but cannot start a timer), and stops once audio
+    // is released and nothing is left. Whatever queues work from the message thread calls wakeTimer().
+    static constexpr int busyTimerHz = 10;
+    static constexpr int idleTimerHz = 1;
+    std::atomic<bool> audioActive{false}; // between prepareToPlay and releaseResources
+
+    void wakeTimer();
+    void updateTimerRate();
+    bool hasPendingWork();
+
+    // Plugin state, including the program bank. getStateInformation writes a compact binary blob (see
+    // PluginProcessor.cpp for the layout); setStateInformation reads that, or the XML wrapped by
+    // copyXmlToBinary() that older versions saved.
+    void writeBinaryState(juce::MemoryBlock& destData);
+    bool readBinaryState(const void* data, int sizeInBytes);
+    void readXmlState(const void* data, int sizeInBytes);
+
+    // Every parameter by the FNV-1a hash of its ID, sorted by hash
+    std::vector<std::pair<juce::uint32, juce::RangedAudioParameter*>> parametersByHash;
+
+    // Tail of the active chain at the current settings: the (non-bypassed) modules' estimates add up in series,
+    // on top of the latency. Configuring a module refreshes its entry in moduleTailSeconds.
+    void updateTail();
+    std::array<double, static_cast<size_t>(DSP_OPTION::END_OF_LIST)> moduleTailSeconds{};
+    std::atomic<double> tailSeconds{0.0};
+    juce::int64 tailSamples = 0;
+
+    // Silence sleep: processBlock skips the DSP once the input has been silent for longer than the tail
+    static constexpr float silenceThreshold = 1.0e-5f; // -100 dB
+    static bool isSilent(const juce::AudioBuffer<float>& buffer, int numChannels);
+    juce::int64 silentSamples = 0;
+
+    // The slot's module fades in and out through context.isBypassed rather than being skipped
+    bool isBypassed(DSP_OPTION option) const;
+    juce::uint32 getBypassMask() const; // one bit per DSP_OPTION
+
+    // Reads the crossfade time and hands it to the transition and every module when it moved
+    void updateCrossfadeTime();
+
+    void processDSPChain(const juce::dsp::AudioBlock<float>& block);
+
+    // Common interface of the module wrappers, so the chain can drive their bypass fades
+    struct DSP_MODULE : juce::dsp::ProcessorBase
+    {
+        virtual void setCrossfadeSeconds(double seconds) = 0;
 
-    // DSP chain configuration
-    DSP_ORDER dspOrder;
-    DSP_POINTERS dspInstances;
+        // Settles on bypassed or active without fading, for a module that is not audible yet
+        virtual void jumpToBypass(bool bypassed) = 0;
+    };
 
-    // Template wrapper for DSP modules
+    // Template wrapper for DSP modules. Processors with latency fade their own bypass (see OversampledStage);
+    // the rest get a BypassCrossfade around them here. Final, so calls on a known DSP_CHOICE are not virtual.
     template <typename T>
-    struct DSP_CHOICE : juce::dsp::ProcessorBase
+    struct DSP_CHOICE final : DSP_MODULE
     {
         void prepare(const juce::dsp::ProcessSpec& spec) override 
         { 
             dsp.prepare(spec); 
+
+            if constexpr (!FadesOwnBypass<T>)
+                bypassFade.prepare(spec);
         }
         
         void process(const juce::dsp::ProcessContextReplacing<float>& context) override 
         { 
-            dsp.process(context); 
+            if constexpr (FadesOwnBypass<T>)
+                dsp.process(context);
+            else
+                bypassFade.process(context, [this](const auto& wetContext) { dsp.process(wetContext); }, [this] { dsp.reset(); });
         }
         
         void reset() override 
@@ -158,21 +491,237 @@ private:
             dsp.reset(); 
         }
 
+        void setCrossfadeSeconds(double seconds) override
+        {
+            if constexpr (FadesOwnBypass<T>)
+                dsp.setCrossfadeSeconds(seconds);
+            else
+                bypassFade.setFadeSeconds(seconds);
+        }
+
+        void jumpToBypass(bool bypassed) override
+        {
+            if constexpr (FadesOwnBypass<T>)
+                dsp.jumpToBypass(bypassed);
+            else
+                bypassFade.jumpTo(bypassed);
+        }
+
         T dsp;
+
+    private:
+        BypassCrossfade bypassFade; // unused when T fades its own bypass
+    };
+
+    // DSP module types
+    using PhaserModule = DSP_CHOICE<StereoPhaser>;
+    using ChorusModule = DSP_CHOICE<MultiVoiceChorus>;
+    using WaveShaperModule = DSP_CHOICE<OversampledStage<WaveShaperStage>>;
+    using LadderFilterModule = DSP_CHOICE<OversampledStage<TieredLadderFilter>>;
+    using GeneralFilterModule = DSP_CHOICE<MultiChannelBiquad>;
+
+    // One of each module, indexed like DSP_OPTION
+    using StaticModules = StaticChain<PhaserModule, ChorusModule, WaveShaperModule, LadderFilterModule, GeneralFilterModule>;
+    static_assert(StaticModules::numModules == static_cast<size_t>(DSP_OPTION::END_OF_LIST));
+
+    // A processing chain: one prepared module instance per slot of its order. An order that uses each
+    // module at most once takes its modules from a StaticModules and runs as that order's specialisation;
+    // anything else (repeats, or static dispatch disabled) owns a DSP_CHOICE per slot and calls them in turn.
+    struct DSP_CHAIN
+    {
+        DSP_ORDER order;
+        std::array<DSP_MODULE*, maxChainLength> modules{}; // per slot, owned by one of the two below
+        std::unique_ptr<StaticModules> staticModules;
+        std::array<std::unique_ptr<DSP_MODULE>, maxChainLength> slotModules;
+        StaticModules::ProcessFunction processStatic = nullptr;
+
+        // The channels this chain processes. On a bus split into channel groups, the chain for the first group
+        // owns one chain per further group, all with the same order.
+        size_t firstChannel = 0;
+        size_t numChannels = 0;
+        std::vector<std::unique_ptr<DSP_CHAIN>> channelGroups;
+
+#if AUDIO_PLUGIN_PROFILING
+        STAGE_PROFILER::StageTicks stageTicks{}; // this group's stage times, until processChain folds them in
+#endif
+    };
+
+    // Chains are created and prepared off the audio thread, published through pendingChain and
+    // picked up by processBlock with a single atomic exchange. The chain they replace keeps running
+    // as fadingChain for the crossfade time, then goes back through retiredChains and is deleted
+    // on the message thread. Only one transition runs at a time, so at most two chains are processed.
+    std::unique_ptr<DSP_CHAIN> createChain(const DSP_ORDER& order) const;
+    std::unique_ptr<DSP_CHAIN> createChannelGroup(const DSP_ORDER& order, size_t firstChannel, size_t numChannels) const;
+    size_t getChannelGroupSize() const;
+    void publishChain(std::unique_ptr<DSP_CHAIN> chain);
+    void pickUpPendingChain();
+    void retireFadingChain();
+    void collectRetiredChains();
+    void syncChainFades(DSP_CHAIN& chain);
+    bool startWorkerThreads(); // with chainBuildLock held; true if the worker count changed
+    void processChain(DSP_CHAIN& chain, const juce::dsp::AudioBlock<float>& block);
+    void processChannelGroup(DSP_CHAIN& group, const juce::dsp::AudioBlock<float>& block, juce::uint32 bypassMask);
+    size_t estimateChainCost(const DSP_CHAIN& chain, size_t channelSamples, juce::uint32 bypassMask) const;
+
+    // One sub-block of a chain's channel groups, handed to the worker pool
+    struct CHANNEL_GROUP_JOB
+    {
+        AudioPluginAudioProcessor* processor = nullptr;
+        DSP_CHAIN* chain = nullptr;
+        juce::dsp::AudioBlock<float> block;
+        juce::uint32 bypassMask = 0;
+    };
+
+    static void processChannelGroupTask(void* job, int groupIndex);
+
+    // Calls fn with every group of a chain, the chain itself first
+    template <typename Fn>
+    static void forEachChannelGroup(DSP_CHAIN& chain, Fn&& fn)
+    {
+        fn(chain);
+
+        for (auto& group : chain.channelGroups)
+            fn(*group);
+    }
+
+    // Calls fn with the processor of every instance of one module type in one channel group of a chain
+    template <typename Module, typename Fn>
+    static void forEachModuleInGroup(DSP_CHAIN* group, DSP_OPTION option, Fn&& fn)
+    {
+        if (group == nullptr)
+            return;
+
+        for (size_t i = 0; i < group->order.size(); ++i)
+        {
+            if (group->order[i] == option && group->modules[i] != nullptr)
+                fn(static_cast<Module&>(*group->modules[i]).dsp);
+        }
+    }
+
+    // ...in every channel group of a chain
+    template <typename Module, typename Fn>
+    static void forEachModuleIn(DSP_CHAIN* chain, DSP_OPTION option, Fn&& fn)
+    {
+        if (chain != nullptr)
+            forEachChannelGroup(*chain, [&](DSP_CHAIN& group) { forEachModuleInGroup<Module>(&group, option, fn); });
+    }
+
+    // ...in the active chain and, during a transition, the outgoing one (so it keeps following automation)
+    template <typename Module, typename Fn>
+    void forEachModule(DSP_OPTION option, Fn&& fn)
+    {
+        forEachModuleIn<Module>(activeChain.get(), option, fn);
+        forEachModuleIn<Module>(fadingChain.get(), option, fn);
+    }
+
+    // Retired chains waiting to be freed; the audio thread holds on to a pending chain rather than overfill this
+    static constexpr int maxRetiredChains = 16;
+
+    DSP_ORDER dspOrder;                             // requested order (message thread side)
+    std::unique_ptr<DSP_CHAIN> activeChain;         // owned by the audio thread
+    std::unique_ptr<DSP_CHAIN> fadingChain;         // the outgoing chain during a transition (audio thread)
+    std::atomic<DSP_CHAIN*> pendingChain{nullptr};
+    SimpleMBComp::Fifo<DSP_CHAIN*> retiredChains;
+    juce::CriticalSection chainBuildLock;           // serialises every non-audio thread that builds or frees chains
+    bool isPrepared = false;
+    bool staticDispatch = true;                     // read by createChain
+    std::atomic<bool> fusedTiling{true};            // read by getSubBlockSize
+    int numWorkerThreads = 0;                       // read by createChain
+    RealtimeWorkerPool workerPool;
+
+    // Chain transition state, sized in prepareToPlay
+    juce::SmoothedValue<float> chainFade;   // weight of the incoming chain
+    juce::AudioBuffer<float> chainFadeScratch; // the outgoing chain's output
+    std::vector<float> chainFadeGains;
+    float appliedCrossfadeMs = -1.0f;
+
+    // Preset bank (see storePreset)
+    struct PRESET
+    {
+        juce::String name;
+        DSP_ORDER order;
+        std::vector<float> values; // denormalised, indexed like presetSources
+        BiquadCoefficients generalFilterCoefficients; // at the prepared sample rate
     };
 
-    // DSP module instances
-    DSP_CHOICE<juce::dsp::Phaser<float>> phaser;
-    DSP_CHOICE<juce::dsp::Chorus<float>> chorus;
-    DSP_CHOICE<juce::dsp::WaveShaper<float, std::function<float(float)>>> waveShaper;
-    DSP_CHOICE<juce::dsp::LadderFilter<float>> ladderFilter;
-    DSP_CHOICE<juce::dsp::IIR::Filter<float>> generalFilter;
+    // A sound parameter (everything but the Processing and Preset options) as stored in a preset
+    struct PRESET_SOURCE
+    {
+        std::atomic<float>* source = nullptr;
+        juce::RangedAudioParameter* parameter = nullptr;
+        bool discrete = false; // choices and bypasses switch halfway through a morph instead of blending
+        juce::uint32 hash = 0; // of the parameter ID, as in the binary state
+    };
+
+    std::unique_ptr<PRESET> capturePreset(const juce::String& name) const;
+    std::unique_ptr<PRESET> readPreset(juce::InputStream& stream) const; // from the binary state; nullptr if truncated
+    void computePresetCoefficients(PRESET& preset) const;
+    void replacePreset(int index, std::unique_ptr<PRESET> preset);
+    void refillPresetChains();
+    void collectRetiredPresets();
+    void acknowledgePresets();
+    void applyPreset(const PRESET& preset);
+    void syncRecalledPreset();
+    void pickUpPendingPreset();
+    void advancePresetMorph(int numSamples);
+
+    // What the audio thread reads for a sound parameter: the host value, unless a recalled preset
+    // (until the message thread has caught the parameters up with it) or a morph overrides it
+    float getParameterValue(const SOUND_PARAMETER& parameter) const;
+    SOUND_PARAMETER getSoundParameter(const juce::String& parameterID) const; // needs presetSources
+
+    std::vector<PRESET_SOURCE> presetSources; // sorted by source address
+
+    // Message thread side. Replaced presets may still be read by the audio thread, so they wait in
+    // retiredPresets until it has acknowledged them (see collectRetiredPresets), or audio stops.
+    struct RETIRED_PRESET
+    {
+        std::unique_ptr<PRESET> preset;
+        juce::uint32 retiredAt = 0; // processedBlocks when it was replaced
+    };
+
+    std::array<std::atomic<PRESET*>, numPresets> presets{};
+    std::vector<RETIRED_PRESET> retiredPresets;
+    std::array<std::atomic<DSP_CHAIN*>, numPresets> presetChains{}; // prepared for each preset's order
+    std::atomic<int> currentProgram{0};
+
+    // Handshake: setCurrentProgram -> pendingProgram -> audio thread -> recalledPreset -> timer -> syncedPreset.
+    // Program changes made off the message thread wait in unappliedProgram for the timer to apply them.
+    std::atomic<int> pendingProgram{-1};
+    std::atomic<int> unappliedProgram{-1};
+    std::atomic<PRESET*> recalledPreset{nullptr};
+    std::atomic<PRESET*> syncedPreset{nullptr};
+    std::atomic<bool> presetChainMissing{false};
+
+    std::atomic<bool> programsChanged{false}; // reported to the host and editor by the timer
+
+    // Audio thread -> timer: blocks processed, and the presets held at the end of the last one
+    std::atomic<juce::uint32> processedBlocks{0};
+    std::array<std::atomic<PRESET*>, 2> presetsInUse{};
+
+    // Audio thread side
+    PRESET* presetA = nullptr; // a recalled program, until the parameters have caught up with it
+    PRESET* presetB = nullptr; // the morph target
+    bool recallPending = false;
+    bool presetOverride = false;
+    bool reconfigureAll = false;
+    juce::SmoothedValue<float> presetMorph;
+
+    // General Filter coefficients, computed in place and swapped into generalFilter without allocating
+    BiquadCoefficientEngine generalFilterCoefficients;
+    BiquadCoefficients activeGeneralFilterCoefficients;
 
     // Processing utilities
     juce::dsp::ProcessSpec spec;
+
+#if AUDIO_PLUGIN_PROFILING
+    STAGE_PROFILER stageProfiler;
+#endif
     
-    // Configuration method
+    // Configuration methods
     void configureDSPModules();
+    void configureDSPModule(DSP_OPTION option);
+    void configureChangedDSPModules();
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    Shared pieces of the benchmark tool: options, results and timing, and
+    the fixture the processBlock suites share.
+
+    Every suite appends BenchmarkResults with a unique name; Main.cpp writes
+    them to JSON and compares them against a stored baseline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../../Source/PluginProcessor.h"
+
+struct BenchmarkOptions
+{
+    juce::Array<int> blockSizes{32, 64, 128, 256, 512, 1024, 2048, 4096};
+    juce::Array<int> channelCounts{1, 2};
+    juce::Array<double> sampleRates{44100.0, 48000.0, 96000.0, 192000.0};
+    juce::StringArray suites;    // empty means every suite
+    juce::StringArray modules;   // empty means every module plus the full chain
+    juce::StringArray states;    // empty means every parameter state
+    double secondsPerRepeat = 0.25; // audio rendered per timed repeat
+    int repeats = 5;
+};
+
+struct BenchmarkResult
+{
+    juce::String suite;
+    juce::String name; // unique key used for the baseline comparison
+    juce::NamedValueSet properties; // descriptive fields copied into the JSON
+    double nsPerSample = 0.0; // per sample frame, i.e. all channels of one sample (per call for the state suite)
+};
+
+using BenchmarkResults = std::vector<BenchmarkResult>;
+
+// Accumulates the time spent between start() and stop() over several calls
+struct StopWatch
+{
+    void start() noexcept { startTicks = juce::Time::getHighResolutionTicks(); }
+    void stop() noexcept { elapsedTicks += juce::Time::getHighResolutionTicks() - startTicks; }
+    void clear() noexcept { elapsedTicks = 0; }
+
+    double getNanoseconds() const noexcept { return juce::Time::highResolutionTicksToSeconds(elapsedTicks) * 1.0e9; }
+
+private:
+    juce::int64 startTicks = 0;
+    juce::int64 elapsedTicks = 0;
+};
+
+// Runs one untimed warm-up and then the timed repeats, returning the median ns per sample frame.
+// runRepeat(stopWatch) must time only the work being measured.
+template <typename RunRepeat>
+double measureNsPerSample(int repeats, juce::int64 samplesPerRepeat, RunRepeat &&runRepeat)
+{
+    StopWatch stopWatch;
+    runRepeat(stopWatch);
+
+    std::vector<double> timings;
+
+    for (int i = 0; i < juce::jmax(1, repeats); ++i)
+    {
+        stopWatch.clear();
+        runRepeat(stopWatch);
+        timings.push_back(stopWatch.getNanoseconds() / static_cast<double>(juce::jmax<juce::int64>(1, samplesPerRepeat)));
+    }
+
+    std::sort(timings.begin(), timings.end());
+    return timings[timings.size() / 2];
+}
+
+// The modules as the suites name them, with their bypass parameter and parameter ID prefix
+struct BenchmarkModule
+{
+    const char *name;
+    const char *bypassID;
+    const char *parameterPrefix;
+};
+
+inline constexpr std::array<BenchmarkModule, 5> benchmarkModules{{{"Phaser", "Phaser Bypass", "Phaser "},
+                                                                  {"Chorus", "Chorus Bypass", "Chorus "},
+                                                                  {"WaveShaper", "WaveShaper Bypass", "WaveShaper "},
+                                                                  {"LadderFilter", "Ladder Filter Bypass", "Ladder Filter "},
+                                                                  {"GeneralFilter", "General Filter Bypass", "General Filter "}}};
+
+// The target that runs every module
+inline const juce::String chainName("Chain");
+
+// Leaves only the target running (every module for chainName), or bypasses everything
+inline void setModuleBypasses(AudioPluginAudioProcessor &processor, const juce::String &target, bool bypassEverything = false)
+{
+    for (const auto &module : benchmarkModules)
+    {
+        auto *bypass = processor.apvts.getParameter(module.bypassID);
+        jassert(bypass != nullptr);
+
+        const auto enabled = !bypassEverything && (target == chainName || target == module.name);
+        bypass->setValueNotifyingHost(enabled ? 0.0f : 1.0f);
+    }
+}
+
+// Prepares the processor for numChannels in and out, then feeds it secondsPerRepeat of fresh noise (or silence)
+// per repeat through processBlock in blockSize blocks, after one untimed warm-up pass, and releases it.
+// Returns the median ns per sample frame. beforeBlock(blockIndex, stopWatch) runs ahead of every block inside the
+// timing, and may stop and restart the stop watch around work the plugin would not do on the audio thread.
+// With blockNs, every timed block's own time is appended to it as well.
+template <typename BeforeBlock>
+double timeProcessBlock(AudioPluginAudioProcessor &processor, int numChannels, double sampleRate, int blockSize,
+                        const BenchmarkOptions &options, BeforeBlock &&beforeBlock, bool silentInput = false,
+                        std::vector<double> *blockNs = nullptr)
+{
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRepeat * sampleRate / blockSize));
+    const auto numSamples = numBlocks * blockSize;
+
+    juce::AudioBuffer<float> audio(numChannels, numSamples);
+    juce::MidiBuffer midi;
+    juce::Random random(0x5eed);
+    auto warmUp = true;
+
+    const auto nsPerSample = measureNsPerSample(options.repeats, numSamples, [&](StopWatch &stopWatch)
+    {
+        // Fresh noise for every repeat, so the previous output is never fed back in
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto *data = audio.getWritePointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = silentInput ? 0.0f : (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+        }
+
+        stopWatch.start();
+
+        for (int position = 0, blockIndex = 0; position < numSamples; position += blockSize, ++blockIndex)
+        {
+            beforeBlock(blockIndex, stopWatch);
+
+            juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), numChannels, position, blockSize);
+            const auto blockStart = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+
+            if (blockNs != nullptr && !warmUp)
+                blockNs->push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStart) * 1.0e9);
+        }
+
+        stopWatch.stop();
+        warmUp = false;
+    });
+
+    processor.releaseResources();
+    return nsPerSample;
+}
+
+inline double timeProcessBlock(AudioPluginAudioProcessor &processor, int numChannels, double sampleRate, int blockSize,
+                               const BenchmarkOptions &options)
+{
+    return timeProcessBlock(processor, numChannels, sampleRate, blockSize, options, [](int, StopWatch &) {});
+}
+
+// Suites
+void runProcessorBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runStateBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runPhaserBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runChorusBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runDispatchBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runTilingBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runChannelBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runParallelBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runSubBlockBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
+void runBiquadBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results);
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    Biquad suite: ns/sample of the General Filter's MultiChannelBiquad against
+    the juce::dsp::IIR::Filter it replaced (one per channel through a
+    ProcessorDuplicator), on their own, with the same peak coefficients.
+
+    "maxDifference" is the largest absolute difference between the two
+    outputs for the same input; both run transposed direct form II in
+    single precision, so it only shows rounding.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../../Source/DSP/MultiChannelBiquad.h"
+
+namespace
+{
+using JuceFilter = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>;
+
+constexpr float frequency = 1000.0f;
+constexpr float quality = 0.707f;
+constexpr float gainDb = 6.0f;
+
+BiquadCoefficients makeCoefficients(double sampleRate)
+{
+    BiquadCoefficients coefficients;
+    coefficients.compute(BiquadCoefficients::Mode::Peak, sampleRate, frequency, quality, gainDb);
+    return coefficients;
+}
+
+void prepareFilter(JuceFilter &filter, const juce::dsp::ProcessSpec &spec)
+{
+    const auto [b0, b1, b2, a1, a2] = makeCoefficients(spec.sampleRate).raw;
+    filter.state = new juce::dsp::IIR::Coefficients<float>(b0, b1, b2, 1.0f, a1, a2);
+    filter.prepare(spec);
+    filter.reset();
+}
+
+void prepareFilter(MultiChannelBiquad &filter, const juce::dsp::ProcessSpec &spec)
+{
+    filter.prepare(spec);
+    filter.setCoefficients(makeCoefficients(spec.sampleRate));
+}
+
+juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples)
+{
+    juce::AudioBuffer<float> audio(numChannels, numSamples);
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto *data = audio.getWritePointer(ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+    }
+
+    return audio;
+}
+
+template <typename Filter>
+void render(Filter &filter, juce::AudioBuffer<float> &audio, int blockSize)
+{
+    for (int position = 0; position < audio.getNumSamples(); position += blockSize)
+    {
+        const auto length = juce::jmin(blockSize, audio.getNumSamples() - position);
+        auto block = juce::dsp::AudioBlock<float>(audio).getSubBlock(static_cast<size_t>(position), static_cast<size_t>(length));
+        filter.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+}
+
+float measureMaxDifference(int numChannels, double sampleRate, int blockSize)
+{
+    const auto numSamples = juce::roundToInt(sampleRate * 0.1);
+    const juce::dsp::ProcessSpec spec{sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)};
+
+    JuceFilter juceFilter;
+    MultiChannelBiquad biquad;
+    prepareFilter(juceFilter, spec);
+    prepareFilter(biquad, spec);
+
+    auto juceOutput = makeNoise(numChannels, numSamples);
+    auto biquadOutput = juceOutput;
+    render(juceFilter, juceOutput, blockSize);
+    render(biquad, biquadOutput, blockSize);
+
+    float maxDifference = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            maxDifference = juce::jmax(maxDifference, std::abs(juceOutput.getSample(ch, i) - biquadOutput.getSample(ch, i)));
+    }
+
+    return maxDifference;
+}
+
+template <typename Filter>
+double timeFilter(int numChannels, double sampleRate, int blockSize, const BenchmarkOptions &options)
+{
+    Filter filter;
+    prepareFilter(filter, {sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRepeat * sampleRate / blockSize));
+    const auto numSamples = numBlocks * blockSize;
+    juce::AudioBuffer<float> audio;
+
+    return measureNsPerSample(options.repeats, numSamples, [&](StopWatch &stopWatch)
+    {
+        audio = makeNoise(numChannels, numSamples);
+
+        stopWatch.start();
+        render(filter, audio, blockSize);
+        stopWatch.stop();
+    });
+}
+} // namespace
+
+void runBiquadBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto numChannels : options.channelCounts)
+        {
+            for (auto blockSize : options.blockSizes)
+            {
+                const auto maxDifference = measureMaxDifference(numChannels, sampleRate, blockSize);
+
+                for (auto simd : {false, true})
+                {
+                    const juce::String implementation = simd ? "MultiChannel" : "JUCE";
+
+                    BenchmarkResult result;
+                    result.suite = "biquad";
+                    result.name = "Biquad/" + implementation + "/" + juce::String(blockSize) + "/" + juce::String(numChannels) + "ch/" +
+                                  juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                    result.properties.set("implementation", implementation);
+                    result.properties.set("blockSize", blockSize);
+                    result.properties.set("channels", numChannels);
+                    result.properties.set("sampleRate", sampleRate);
+                    result.properties.set("maxDifference", maxDifference);
+                    result.nsPerSample = simd ? timeFilter<MultiChannelBiquad>(numChannels, sampleRate, blockSize, options)
+                                              : timeFilter<JuceFilter>(numChannels, sampleRate, blockSize, options);
+                    results.push_back(result);
+
+                    std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample" << std::endl;
+                }
+            }
+        }
+    }
+}
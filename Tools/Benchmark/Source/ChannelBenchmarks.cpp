@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Channels suite: each module and the full chain through processBlock at
+    1, 2, 6 (5.1), 8 (7.1) and 16 channels, static parameters, 512-sample
+    blocks.
+
+    Results carry nsPerChannelSample as well as the usual ns per sample
+    frame. The stages process channels in SIMD-width groups (voices, for the
+    Chorus), so nsPerChannelSample should stay roughly flat as the count
+    grows; a channel count that is not a multiple of the SIMD width pays for
+    the unused lanes of its last group.
+
+    The suite keeps its own channel counts, since the range is the point of
+    it; --sample-rates and --modules apply as usual.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+constexpr std::array<int, 5> channelCounts{1, 2, 6, 8, 16};
+constexpr int channelBlockSize = 512;
+
+double timeTarget(const juce::String &target, int numChannels, double sampleRate, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    setModuleBypasses(processor, target);
+
+    return timeProcessBlock(processor, numChannels, sampleRate, channelBlockSize, options);
+}
+} // namespace
+
+void runChannelBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    juce::StringArray targets;
+
+    for (const auto &module : benchmarkModules)
+        targets.add(module.name);
+
+    targets.add(chainName);
+
+    for (const auto &target : targets)
+    {
+        if (!options.modules.isEmpty() && !options.modules.contains(target))
+            continue;
+
+        for (auto sampleRate : options.sampleRates)
+        {
+            for (auto numChannels : channelCounts)
+            {
+                BenchmarkResult result;
+                result.suite = "channels";
+                result.name = "Channels/" + target + "/" + juce::String(numChannels) + "ch/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                result.properties.set("target", target);
+                result.properties.set("blockSize", channelBlockSize);
+                result.properties.set("channels", numChannels);
+                result.properties.set("sampleRate", sampleRate);
+                result.nsPerSample = timeTarget(target, numChannels, sampleRate, options);
+                result.properties.set("nsPerChannelSample", result.nsPerSample / numChannels);
+                results.push_back(result);
+
+                std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample, "
+                          << juce::String(result.nsPerSample / numChannels, 2) << " ns/channel-sample" << std::endl;
+            }
+        }
+    }
+}
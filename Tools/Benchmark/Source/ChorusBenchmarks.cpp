@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    Chorus suite: ns/sample of an ensemble of 1, 4 and 8 voices, built the
+    old way (that many juce::dsp::Chorus instances, phase-offset, on copies
+    of the input and summed, as stacked plugin instances would) and with
+    MultiVoiceChorus under each interpolation.
+
+    "delayBytes" is the delay memory of one instance or stack at that
+    sample rate and channel count, and "windowBytes" the part of it the
+    voices cycle through at these settings: all of it for the stack, the
+    active window for MultiVoiceChorus.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../../Source/DSP/MultiVoiceChorus.h"
+
+namespace
+{
+constexpr float rateHz = 0.8f;
+constexpr float depth = 0.5f;
+constexpr float centreDelayMs = 7.0f;
+constexpr float feedback = 0.3f;
+constexpr float mix = 0.5f;
+
+template <typename Chorus>
+void configure(Chorus &chorus)
+{
+    chorus.setRate(rateHz);
+    chorus.setDepth(depth);
+    chorus.setCentreDelay(centreDelayMs);
+    chorus.setFeedback(feedback);
+    chorus.setMix(mix);
+}
+
+juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples, juce::Random &random)
+{
+    juce::AudioBuffer<float> audio(numChannels, numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto *data = audio.getWritePointer(ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+    }
+
+    return audio;
+}
+
+// numVoices juce::dsp::Chorus instances, each on its own copy of every block, summed at equal power
+double timeStack(int numVoices, int numChannels, double sampleRate, int blockSize, const BenchmarkOptions &options)
+{
+    const juce::dsp::ProcessSpec spec{sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)};
+    std::vector<std::unique_ptr<juce::dsp::Chorus<float>>> stack;
+
+    for (int voice = 0; voice < numVoices; ++voice)
+    {
+        stack.push_back(std::make_unique<juce::dsp::Chorus<float>>());
+        stack.back()->prepare(spec);
+        configure(*stack.back());
+        stack.back()->reset();
+    }
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRepeat * sampleRate / blockSize));
+    const auto numSamples = numBlocks * blockSize;
+    const auto gain = 1.0f / std::sqrt(static_cast<float>(numVoices));
+
+    juce::Random random(0x5eed);
+    juce::AudioBuffer<float> audio;
+    juce::AudioBuffer<float> voice(numChannels, blockSize);
+    juce::AudioBuffer<float> sum(numChannels, blockSize);
+
+    // Offset the instances' LFOs as an ensemble would, by running each a different amount of silence first
+    voice.clear();
+
+    for (int v = 1; v < numVoices; ++v)
+    {
+        const auto warmUpBlocks = juce::roundToInt(v * sampleRate / (rateHz * numVoices * blockSize));
+
+        for (int b = 0; b < warmUpBlocks; ++b)
+        {
+            juce::dsp::AudioBlock<float> block(voice);
+            stack[static_cast<size_t>(v)]->process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+    }
+
+    return measureNsPerSample(options.repeats, numSamples, [&](StopWatch &stopWatch)
+    {
+        audio = makeNoise(numChannels, numSamples, random);
+
+        stopWatch.start();
+
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            sum.clear();
+
+            for (auto &chorus : stack)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    voice.copyFrom(ch, 0, audio, ch, position, blockSize);
+
+                juce::dsp::AudioBlock<float> block(voice);
+                chorus->process(juce::dsp::ProcessContextReplacing<float>(block));
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    sum.addFrom(ch, 0, voice, ch, 0, blockSize, gain);
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                audio.copyFrom(ch, position, sum, ch, 0, blockSize);
+        }
+
+        stopWatch.stop();
+    });
+}
+
+double timeMultiVoice(int numVoices, MultiVoiceChorus::Interpolation interpolation, int numChannels, double sampleRate,
+                      int blockSize, const BenchmarkOptions &options)
+{
+    MultiVoiceChorus chorus;
+    chorus.prepare({sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+    configure(chorus);
+    chorus.setNumVoices(numVoices);
+    chorus.setInterpolation(interpolation);
+    chorus.reset();
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRepeat * sampleRate / blockSize));
+    const auto numSamples = numBlocks * blockSize;
+
+    juce::Random random(0x5eed);
+    juce::AudioBuffer<float> audio;
+
+    return measureNsPerSample(options.repeats, numSamples, [&](StopWatch &stopWatch)
+    {
+        audio = makeNoise(numChannels, numSamples, random);
+
+        stopWatch.start();
+
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            auto block = juce::dsp::AudioBlock<float>(audio).getSubBlock(static_cast<size_t>(position), static_cast<size_t>(blockSize));
+            chorus.process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+
+        stopWatch.stop();
+    });
+}
+
+// Delay memory, in bytes. Both size a line per channel for the longest centre delay plus the modulation
+// (110 ms), but a stack has one set of lines per voice where MultiVoiceChorus shares one between them.
+size_t getDelayBytes(bool stacked, int numVoices, int numChannels, double sampleRate)
+{
+    const auto lineMs = static_cast<double>(MultiVoiceChorus::maxCentreDelayMs + MultiVoiceChorus::maxModulationMs);
+    const auto lines = static_cast<size_t>(numChannels) * (stacked ? static_cast<size_t>(numVoices) : 1);
+
+    return lines * static_cast<size_t>(std::ceil(lineMs * 0.001 * sampleRate)) * sizeof(float);
+}
+
+// The delay memory MultiVoiceChorus actually cycles through at the benchmark's centre delay and depth
+size_t getWindowBytes(int numChannels, double sampleRate)
+{
+    MultiVoiceChorus chorus;
+    configure(chorus);
+    chorus.prepare({sampleRate, 512, static_cast<juce::uint32>(numChannels)});
+
+    return static_cast<size_t>(numChannels) * chorus.getActiveWindowSize() * sizeof(float);
+}
+
+BenchmarkResult makeResult(const juce::String &implementation, int numVoices, int numChannels, double sampleRate,
+                           int blockSize, size_t delayBytes, size_t windowBytes, double nsPerSample)
+{
+    BenchmarkResult result;
+    result.suite = "chorus";
+    result.name = "Chorus/" + implementation + "/" + juce::String(numVoices) + "/" + juce::String(blockSize) + "/" +
+                  juce::String(numChannels) + "ch/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+    result.properties.set("implementation", implementation);
+    result.properties.set("voices", numVoices);
+    result.properties.set("blockSize", blockSize);
+    result.properties.set("channels", numChannels);
+    result.properties.set("sampleRate", sampleRate);
+    result.properties.set("delayBytes", static_cast<juce::int64>(delayBytes));
+    result.properties.set("windowBytes", static_cast<juce::int64>(windowBytes));
+    result.nsPerSample = nsPerSample;
+    return result;
+}
+} // namespace
+
+void runChorusBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    using Interpolation = MultiVoiceChorus::Interpolation;
+
+    const std::array<std::pair<Interpolation, const char *>, 3> interpolations{{{Interpolation::Linear, "Linear"},
+                                                                                {Interpolation::Lagrange3rd, "Lagrange"},
+                                                                                {Interpolation::Thiran, "Thiran"}}};
+
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto numChannels : options.channelCounts)
+        {
+            const auto windowBytes = getWindowBytes(numChannels, sampleRate);
+
+            for (auto blockSize : options.blockSizes)
+            {
+                for (auto numVoices : {1, 4, MultiVoiceChorus::maxVoices})
+                {
+                    const auto first = results.size();
+
+                    const auto stackBytes = getDelayBytes(true, numVoices, numChannels, sampleRate);
+
+                    results.push_back(makeResult("JUCE", numVoices, numChannels, sampleRate, blockSize, stackBytes, stackBytes,
+                                                 timeStack(numVoices, numChannels, sampleRate, blockSize, options)));
+
+                    for (const auto &[interpolation, name] : interpolations)
+                    {
+                        results.push_back(makeResult(juce::String("MultiVoice") + name, numVoices, numChannels, sampleRate, blockSize,
+                                                     getDelayBytes(false, numVoices, numChannels, sampleRate), windowBytes,
+                                                     timeMultiVoice(numVoices, interpolation, numChannels, sampleRate, blockSize, options)));
+                    }
+
+                    for (auto i = first; i < results.size(); ++i)
+                        std::cout << results[i].name << ": " << juce::String(results[i].nsPerSample, 2) << " ns/sample" << std::endl;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Dispatch suite: ns/sample of the full chain in the default order through
+    processBlock, with the compile-time specialised chain ("Static") and
+    with the per-slot DSP_CHOICE fallback ("Virtual").
+
+    "Active" runs every module at its defaults; "Bypassed" bypasses them
+    all, so what is left is mostly the per-block cost of getting through
+    the chain. The gap between the two dispatches is largest at small
+    block sizes, where that cost is paid most often.
+
+    Profiling builds time every stage on its own and so never take the
+    static path; the suite only builds with AUDIO_PLUGIN_PROFILING=0, as
+    Benchmark.jucer sets it.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+static_assert(!AUDIO_PLUGIN_PROFILING, "the Static and Virtual rows would both time the per-slot path");
+
+namespace
+{
+double timeChain(bool staticDispatch, bool bypassed, int numChannels, double sampleRate, int blockSize, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    processor.setStaticDispatch(staticDispatch);
+    setModuleBypasses(processor, chainName, bypassed);
+
+    return timeProcessBlock(processor, numChannels, sampleRate, blockSize, options);
+}
+} // namespace
+
+void runDispatchBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto numChannels : options.channelCounts)
+        {
+            for (auto blockSize : options.blockSizes)
+            {
+                for (auto bypassed : {false, true})
+                {
+                    for (auto staticDispatch : {true, false})
+                    {
+                        const juce::String dispatch = staticDispatch ? "Static" : "Virtual";
+                        const juce::String state = bypassed ? "Bypassed" : "Active";
+
+                        BenchmarkResult result;
+                        result.suite = "dispatch";
+                        result.name = "Dispatch/" + dispatch + "/" + state + "/" + juce::String(blockSize) + "/" +
+                                      juce::String(numChannels) + "ch/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                        result.properties.set("dispatch", dispatch);
+                        result.properties.set("state", state);
+                        result.properties.set("blockSize", blockSize);
+                        result.properties.set("channels", numChannels);
+                        result.properties.set("sampleRate", sampleRate);
+                        result.nsPerSample = timeChain(staticDispatch, bypassed, numChannels, sampleRate, blockSize, options);
+                        results.push_back(result);
+
+                        std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
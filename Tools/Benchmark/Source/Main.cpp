@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    Benchmark tool.
+
+    Runs the benchmark suites, writes every result to JSON and, given a
+    baseline written by an earlier run, fails when any result got slower
+    than the allowed threshold.
+
+    Usage:
+      Benchmark [--output=benchmark.json] [--baseline=<json>] [--threshold=<percent>] [--suites=processor,state,phaser,chorus,dispatch,tiling,channels,parallel,subblock,biquad]
+                [--block-sizes=32,...] [--channels=1,2] [--sample-rates=44100,...]
+                [--modules=WaveShaper,Chain,...] [--states=Static,Automated,Bypassed]
+                [--seconds=<audio per repeat>] [--repeats=<n>]
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+constexpr double defaultThresholdPercent = 10.0;
+
+juce::StringArray getListOption(const juce::ArgumentList &args, juce::StringRef option)
+{
+    return juce::StringArray::fromTokens(args.getValueForOption(option), ",", {});
+}
+
+void parseOptions(const juce::ArgumentList &args, BenchmarkOptions &options)
+{
+    if (args.containsOption("--block-sizes"))
+    {
+        options.blockSizes.clear();
+
+        for (const auto &value : getListOption(args, "--block-sizes"))
+            options.blockSizes.add(juce::jmax(1, value.getIntValue()));
+    }
+
+    if (args.containsOption("--channels"))
+    {
+        options.channelCounts.clear();
+
+        for (const auto &value : getListOption(args, "--channels"))
+            options.channelCounts.add(juce::jmax(1, value.getIntValue()));
+    }
+
+    if (args.containsOption("--sample-rates"))
+    {
+        options.sampleRates.clear();
+
+        for (const auto &value : getListOption(args, "--sample-rates"))
+            options.sampleRates.add(value.getDoubleValue());
+    }
+
+    if (args.containsOption("--suites"))
+        options.suites = getListOption(args, "--suites");
+
+    if (args.containsOption("--modules"))
+        options.modules = getListOption(args, "--modules");
+
+    if (args.containsOption("--states"))
+        options.states = getListOption(args, "--states");
+
+    if (args.containsOption("--seconds"))
+        options.secondsPerRepeat = juce::jmax(0.001, args.getValueForOption("--seconds").getDoubleValue());
+
+    if (args.containsOption("--repeats"))
+        options.repeats = juce::jmax(1, args.getValueForOption("--repeats").getIntValue());
+}
+
+juce::var toJson(const BenchmarkResults &results)
+{
+    juce::Array<juce::var> entries;
+
+    for (const auto &result : results)
+    {
+        auto *entry = new juce::DynamicObject();
+        entry->setProperty("suite", result.suite);
+        entry->setProperty("name", result.name);
+
+        for (const auto &property : result.properties)
+            entry->setProperty(property.name, property.value);
+
+        entry->setProperty("nsPerSample", result.nsPerSample);
+        entries.add(juce::var(entry));
+    }
+
+    auto *root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("results", entries);
+    return juce::var(root);
+}
+
+// Returns the number of results that got slower than the threshold allows
+int compareWithBaseline(const BenchmarkResults &results, const juce::var &baseline, double thresholdPercent)
+{
+    std::map<juce::String, double> baselineTimes;
+
+    if (auto *entries = baseline["results"].getArray())
+    {
+        for (const auto &entry : *entries)
+            baselineTimes[entry["name"].toString()] = static_cast<double>(entry["nsPerSample"]);
+    }
+
+    int compared = 0;
+    int regressions = 0;
+
+    for (const auto &result : results)
+    {
+        auto found = baselineTimes.find(result.name);
+
+        if (found == baselineTimes.end() || found->second <= 0.0)
+            continue;
+
+        ++compared;
+        const auto changePercent = (result.nsPerSample / found->second - 1.0) * 100.0;
+
+        if (changePercent > thresholdPercent)
+        {
+            ++regressions;
+            std::cout << "REGRESSION " << result.name << ": " << juce::String(found->second, 2) << " -> "
+                      << juce::String(result.nsPerSample, 2) << " ns/sample (+" << juce::String(changePercent, 1) << "%)\n";
+        }
+    }
+
+    std::cout << compared << " result(s) compared against the baseline, " << regressions << " over the "
+              << juce::String(thresholdPercent, 1) << "% threshold\n";
+
+    return regressions;
+}
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    BenchmarkOptions options;
+    parseOptions(args, options);
+
+    BenchmarkResults results;
+
+    if (options.suites.isEmpty() || options.suites.contains("processor"))
+        runProcessorBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("state"))
+        runStateBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("phaser"))
+        runPhaserBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("chorus"))
+        runChorusBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("dispatch"))
+        runDispatchBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("tiling"))
+        runTilingBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("channels"))
+        runChannelBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("parallel"))
+        runParallelBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("subblock"))
+        runSubBlockBenchmarks(options, results);
+
+    if (options.suites.isEmpty() || options.suites.contains("biquad"))
+        runBiquadBenchmarks(options, results);
+
+    const auto output = juce::File::getCurrentWorkingDirectory().getChildFile(
+        args.containsOption("--output") ? args.getValueForOption("--output") : juce::String("benchmark.json"));
+
+    if (!output.replaceWithText(juce::JSON::toString(toJson(results))))
+    {
+        std::cerr << "Cannot write " << output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    std::cout << "Wrote " << results.size() << " result(s) to " << output.getFullPathName() << "\n";
+
+    if (!args.containsOption("--baseline"))
+        return 0;
+
+    const auto baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--baseline"));
+    const auto baseline = juce::JSON::parse(baselineFile);
+
+    if (!baseline.isObject())
+    {
+        std::cerr << "Cannot read baseline " << baselineFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    const auto threshold = args.containsOption("--threshold") ? args.getValueForOption("--threshold").getDoubleValue()
+                                                              : defaultThresholdPercent;
+
+    return compareWithBaseline(results, baseline, threshold) == 0 ? 0 : 2;
+}
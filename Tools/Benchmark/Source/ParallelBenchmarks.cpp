@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    Parallel suite: the full chain through processBlock at 2, 8 and 16
+    channels with 0 (serial), 1, 3 and 7 worker threads, static parameters,
+    512-sample blocks and the parallel threshold at zero, so every block
+    with more than one channel group goes through the pool.
+
+    Every block is timed on its own. Results carry the median ns per sample
+    frame (nsPerSample, what the baseline compares), the 99th percentile
+    and worst block as a fraction of the block's deadline, and the jitter
+    (p99 minus median, in microseconds): the handoff and join cost shows up
+    in the tail rather than the median.
+
+    Stereo is a single channel group, so its rows show that a pool costs
+    nothing where there is nothing to split. --sample-rates applies as
+    usual.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+constexpr std::array<int, 3> channelCounts{2, 8, 16};
+constexpr std::array<int, 4> workerCounts{0, 1, 3, 7};
+constexpr int parallelBlockSize = 512;
+
+struct BlockTimings
+{
+    double medianNs = 0.0; // per block
+    double p99Ns = 0.0;
+    double worstNs = 0.0;
+};
+
+BlockTimings timeBlocks(int numChannels, int numWorkers, double sampleRate, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    processor.setWorkerThreads(numWorkers);
+    processor.setParallelThreshold(0);
+
+    std::vector<double> blockNs;
+    timeProcessBlock(processor, numChannels, sampleRate, parallelBlockSize, options, [](int, StopWatch &) {}, false, &blockNs);
+
+    std::sort(blockNs.begin(), blockNs.end());
+
+    BlockTimings timings;
+    timings.medianNs = blockNs[blockNs.size() / 2];
+    timings.p99Ns = blockNs[juce::jmin(blockNs.size() - 1, blockNs.size() * 99 / 100)];
+    timings.worstNs = blockNs.back();
+    return timings;
+}
+} // namespace
+
+void runParallelBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    for (auto sampleRate : options.sampleRates)
+    {
+        const auto deadlineNs = parallelBlockSize / sampleRate * 1.0e9;
+
+        for (auto numChannels : channelCounts)
+        {
+            for (auto numWorkers : workerCounts)
+            {
+                const auto timings = timeBlocks(numChannels, numWorkers, sampleRate, options);
+
+                BenchmarkResult result;
+                result.suite = "parallel";
+                result.name = "Parallel/" + juce::String(numChannels) + "ch/" + juce::String(numWorkers) + "workers/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                result.properties.set("blockSize", parallelBlockSize);
+                result.properties.set("channels", numChannels);
+                result.properties.set("workers", numWorkers);
+                result.properties.set("sampleRate", sampleRate);
+                result.nsPerSample = timings.medianNs / parallelBlockSize;
+                result.properties.set("p99DeadlineFraction", timings.p99Ns / deadlineNs);
+                result.properties.set("worstDeadlineFraction", timings.worstNs / deadlineNs);
+                result.properties.set("jitterUs", (timings.p99Ns - timings.medianNs) * 1.0e-3);
+                results.push_back(result);
+
+                std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample, p99 "
+                          << juce::String(timings.p99Ns / deadlineNs * 100.0, 1) << "% / worst "
+                          << juce::String(timings.worstNs / deadlineNs * 100.0, 1) << "% of the deadline, jitter "
+                          << juce::String((timings.p99Ns - timings.medianNs) * 1.0e-3, 1) << " us" << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    Phaser suite: ns/sample of juce::dsp::Phaser (fixed at 6 stages) and of
+    StereoPhaser at 4, 6 and 12 stages, on their own, with the LFO sweeping
+    fast and feedback on.
+
+    Both run the same cascade (first-order allpasses prewarped to the same
+    cutoff, feedback from the previous output, the same logarithmic sweep)
+    and differ in how the sweep reaches the coefficients: juce::dsp::Phaser
+    holds each cutoff for 4 samples, StereoPhaser interpolates between exact
+    values every 8. "sweepErrorDb" is the error of each scheme against a
+    double precision render with exact coefficients every sample, for the
+    6 stage cascade. The hold is emulated here on the same cascade (and
+    centred on its 4 samples, its best case), since juce::dsp::Phaser's LFO
+    cannot be phase-aligned with a reference from the outside.
+
+    "juceMaxDifference" is the largest absolute difference between
+    juce::dsp::Phaser and a 6 stage StereoPhaser with no stereo offset on
+    the same stereo input, with the depth at 0 so neither sweeps. The two
+    run the same allpass response through different structures in single
+    precision, so it only shows rounding; anything more means the feedback
+    or the mix no longer matches. Debug builds assert that it stays under
+    juceTolerance.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../../Source/DSP/StereoPhaser.h"
+
+namespace
+{
+constexpr float rateHz = 2.0f;
+constexpr float depth = 1.0f;
+constexpr float centreHz = 1000.0f;
+constexpr float feedback = 0.5f;
+constexpr float mix = 1.0f; // wet only, so the error is not diluted by the dry signal
+constexpr int juceStages = 6;
+constexpr float juceMix = 0.5f; // half wet, so the comparison covers the dry/wet law as well
+constexpr float juceTolerance = 1.0e-4f;
+
+// The sweep both phasers use: cutoff for an LFO phase (in cycles) of the even channels
+double getSweepCoefficient(double phase, double sampleRate)
+{
+    const auto minFrequency = static_cast<double>(StereoPhaser::minFrequency);
+    const auto maxFrequency = juce::jmin(20000.0, 0.49 * sampleRate);
+    const auto centre = std::log(centreHz / minFrequency) / std::log(maxFrequency / minFrequency);
+    const auto position = juce::jlimit(0.0, 1.0, centre + depth * 0.5 * std::sin(juce::MathConstants<double>::twoPi * phase));
+    const auto t = std::tan(juce::MathConstants<double>::pi * minFrequency * std::pow(maxFrequency / minFrequency, position) / sampleRate);
+
+    return (t - 1.0) / (t + 1.0);
+}
+
+// Double precision cascade. A holdSamples of 1 is the exact reference; larger values hold each coefficient,
+// computed at the centre of the hold, for that many samples.
+std::vector<double> renderReference(const std::vector<float> &input, double sampleRate, int holdSamples)
+{
+    std::array<double, juceStages> stages{};
+    std::vector<double> output(input.size());
+    const auto increment = rateHz / sampleRate;
+    double lastOutput = 0.0;
+    double coefficient = 0.0;
+
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        if (i % static_cast<size_t>(holdSamples) == 0)
+            coefficient = getSweepCoefficient(increment * (static_cast<double>(i) + 0.5 * (holdSamples + 1)), sampleRate);
+
+        auto x = input[i] - lastOutput * feedback;
+
+        for (auto &s : stages)
+        {
+            const auto y = coefficient * x + s;
+            s = x - coefficient * y;
+            x = y;
+        }
+
+        lastOutput = x;
+        output[i] = x;
+    }
+
+    return output;
+}
+
+template <typename Samples>
+double getErrorDb(const Samples &rendered, const std::vector<double> &reference)
+{
+    double error = 0.0, energy = 0.0;
+
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        const auto difference = static_cast<double>(rendered[i]) - reference[i];
+        error += difference * difference;
+        energy += reference[i] * reference[i];
+    }
+
+    return juce::Decibels::gainToDecibels(std::sqrt(error / juce::jmax(energy, 1.0e-30)), -200.0);
+}
+
+// Error of each update scheme against the exact reference, one second of noise at the given rate
+std::pair<double, double> measureSweepErrors(double sampleRate)
+{
+    constexpr int blockSize = 512;
+
+    juce::Random random(0x5eed);
+    std::vector<float> input(static_cast<size_t>(sampleRate));
+
+    for (auto &sample : input)
+        sample = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+
+    const auto reference = renderReference(input, sampleRate, 1);
+    const auto held = renderReference(input, sampleRate, 4);
+
+    StereoPhaser phaser;
+    phaser.prepare({sampleRate, static_cast<juce::uint32>(blockSize), 1});
+    phaser.setRate(rateHz);
+    phaser.setDepth(depth);
+    phaser.setCentreFrequency(centreHz);
+    phaser.setFeedback(feedback);
+    phaser.setMix(mix);
+    phaser.setNumStages(juceStages);
+    phaser.reset();
+
+    auto rendered = input;
+
+    for (size_t start = 0; start < rendered.size(); start += blockSize)
+    {
+        auto *channel = rendered.data() + start;
+        juce::dsp::AudioBlock<float> block(&channel, 1, juce::jmin(static_cast<size_t>(blockSize), rendered.size() - start));
+        phaser.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+
+    return {getErrorDb(held, reference), getErrorDb(rendered, reference)};
+}
+
+// Largest difference between juce::dsp::Phaser and StereoPhaser at the settings they share, half a second of
+// stereo noise at the given rate
+float measureJuceDifference(double sampleRate)
+{
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+
+    const auto numSamples = juce::roundToInt(sampleRate * 0.5);
+    const juce::dsp::ProcessSpec spec{sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)};
+
+    // Set before prepare, so neither ramps from its previous settings
+    const auto configure = [](auto &phaser)
+    {
+        phaser.setRate(rateHz);
+        phaser.setDepth(0.0f);
+        phaser.setCentreFrequency(centreHz);
+        phaser.setFeedback(feedback);
+        phaser.setMix(juceMix);
+    };
+
+    juce::dsp::Phaser<float> juceSubject;
+    configure(juceSubject);
+    juceSubject.prepare(spec);
+
+    StereoPhaser subject;
+    configure(subject);
+    subject.setNumStages(juceStages);
+    subject.setStereoOffset(0.0);
+    subject.prepare(spec);
+
+    juce::AudioBuffer<float> juceOutput(numChannels, numSamples);
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto *data = juceOutput.getWritePointer(ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+    }
+
+    auto output = juceOutput;
+
+    for (int position = 0; position < numSamples; position += blockSize)
+    {
+        const auto start = static_cast<size_t>(position);
+        const auto length = static_cast<size_t>(juce::jmin(blockSize, numSamples - position));
+
+        auto juceBlock = juce::dsp::AudioBlock<float>(juceOutput).getSubBlock(start, length);
+        juceSubject.process(juce::dsp::ProcessContextReplacing<float>(juceBlock));
+
+        auto block = juce::dsp::AudioBlock<float>(output).getSubBlock(start, length);
+        subject.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+
+    float maxDifference = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            maxDifference = juce::jmax(maxDifference, std::abs(juceOutput.getSample(ch, i) - output.getSample(ch, i)));
+    }
+
+    return maxDifference;
+}
+
+template <typename Phaser>
+double timePhaser(Phaser &phaser, int numChannels, double sampleRate, int blockSize, const BenchmarkOptions &options)
+{
+    phaser.prepare({sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+    phaser.setRate(rateHz);
+    phaser.setDepth(depth);
+    phaser.setCentreFrequency(centreHz);
+    phaser.setFeedback(feedback);
+    phaser.setMix(mix);
+    phaser.reset();
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRepeat * sampleRate / blockSize));
+    const auto numSamples = numBlocks * blockSize;
+
+    juce::AudioBuffer<float> audio(numChannels, numSamples);
+    juce::Random random(0x5eed);
+
+    return measureNsPerSample(options.repeats, numSamples, [&](StopWatch &stopWatch)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto *data = audio.getWritePointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+        }
+
+        stopWatch.start();
+
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            auto block = juce::dsp::AudioBlock<float>(audio).getSubBlock(static_cast<size_t>(position), static_cast<size_t>(blockSize));
+            phaser.process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+
+        stopWatch.stop();
+    });
+}
+
+BenchmarkResult makeResult(const juce::String &implementation, int numStages, int numChannels, double sampleRate,
+                           int blockSize, double errorDb, float juceDifference, double nsPerSample)
+{
+    BenchmarkResult result;
+    result.suite = "phaser";
+    result.name = "Phaser/" + implementation + "/" + juce::String(numStages) + "/" + juce::String(blockSize) + "/" +
+                  juce::String(numChannels) + "ch/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+    result.properties.set("implementation", implementation);
+    result.properties.set("stages", numStages);
+    result.properties.set("blockSize", blockSize);
+    result.properties.set("channels", numChannels);
+    result.properties.set("sampleRate", sampleRate);
+    result.properties.set("sweepErrorDb", errorDb);
+    result.properties.set("juceMaxDifference", juceDifference);
+    result.nsPerSample = nsPerSample;
+    return result;
+}
+} // namespace
+
+void runPhaserBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    for (auto sampleRate : options.sampleRates)
+    {
+        const auto [heldErrorDb, interpolatedErrorDb] = measureSweepErrors(sampleRate);
+
+        std::cout << "Phaser sweep error at " << juce::roundToInt(sampleRate) << " Hz: held every 4 samples "
+                  << juce::String(heldErrorDb, 1) << " dB, interpolated every " << static_cast<int>(StereoPhaser::controlInterval)
+                  << " samples " << juce::String(interpolatedErrorDb, 1) << " dB" << std::endl;
+
+        const auto juceDifference = measureJuceDifference(sampleRate);
+        jassert(juceDifference < juceTolerance);
+
+        std::cout << "Phaser against juce::dsp::Phaser at " << juce::roundToInt(sampleRate) << " Hz: max difference "
+                  << juce::String(juceDifference, 7) << (juceDifference < juceTolerance ? "" : " (MISMATCH)") << std::endl;
+
+        for (auto numChannels : options.channelCounts)
+        {
+            for (auto blockSize : options.blockSizes)
+            {
+                juce::dsp::Phaser<float> juceSubject;
+                results.push_back(makeResult("JUCE", juceStages, numChannels, sampleRate, blockSize, heldErrorDb, juceDifference,
+                                             timePhaser(juceSubject, numChannels, sampleRate, blockSize, options)));
+
+                for (auto numStages : {StereoPhaser::minStages, juceStages, StereoPhaser::maxStages})
+                {
+                    StereoPhaser subject;
+                    subject.setNumStages(numStages);
+                    results.push_back(makeResult("Stereo", numStages, numChannels, sampleRate, blockSize, interpolatedErrorDb, juceDifference,
+                                                 timePhaser(subject, numChannels, sampleRate, blockSize, options)));
+                }
+
+                for (auto it = results.end() - 4; it != results.end(); ++it)
+                    std::cout << it->name << ": " << juce::String(it->nsPerSample, 2) << " ns/sample" << std::endl;
+            }
+        }
+    }
+}
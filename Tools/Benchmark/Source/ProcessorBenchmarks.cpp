@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    Processor suite: ns/sample of each DSP module and of the full chain,
+    measured through AudioPluginAudioProcessor::processBlock.
+
+    A module is measured by bypassing every other module, so its figure
+    includes the per-block overhead of processBlock (sub-block splitting,
+    smoothing, reconfiguration). "Chain/Bypassed" measures that overhead on
+    its own. Automated runs also time the parameter changes themselves, as
+    a host delivering automation on the audio thread would pay for them.
+
+    "Toggled" flips the target's bypass often enough that it is nearly always
+    mid-fade, and "Reordered" keeps the chain crossfading between orders; the
+    gap to "Static" is the cost of a transition. Building the new chains is
+    not timed, since that happens on the message thread in the plugin.
+
+    "Silent" feeds digital silence, so after the warm-up the processor is
+    asleep and the figure is what an idle instance costs.
+
+    "Modulated" fills every modulation slot with a routing from the LFOs
+    and envelope followers to the target's float parameters; the gap to
+    "Static" is the cost of the matrix at full load.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+enum class ParameterState
+{
+    Static,    // defaults, nothing moves
+    Automated, // every float parameter of the target swept once per block
+    Bypassed,  // everything bypassed (chain only)
+    Toggled,   // the target's bypass flipped every togglePeriodSeconds
+    Reordered, // a new order every togglePeriodSeconds (chain only)
+    Silent,    // silent input (chain only)
+    Modulated, // every modulation slot routed to the target's float parameters
+    END_OF_LIST
+};
+
+juce::String getStateName(ParameterState state)
+{
+    switch (state)
+    {
+    case ParameterState::Static: return "Static";
+    case ParameterState::Automated: return "Automated";
+    case ParameterState::Bypassed: return "Bypassed";
+    case ParameterState::Toggled: return "Toggled";
+    case ParameterState::Reordered: return "Reordered";
+    case ParameterState::Silent: return "Silent";
+    case ParameterState::Modulated: return "Modulated";
+    default: break;
+    }
+
+    return {};
+}
+
+// Slow enough to stay within the smoothing time, fast enough to keep every module reconfiguring
+constexpr double automationRateHz = 2.0;
+
+// Just over the default crossfade time, so transitions run back to back
+constexpr double togglePeriodSeconds = 0.035;
+
+juce::Array<juce::RangedAudioParameter *> getAutomatedParameters(AudioPluginAudioProcessor &processor, const juce::String &target)
+{
+    juce::Array<juce::RangedAudioParameter *> parameters;
+    juce::String prefix;
+
+    for (const auto &module : benchmarkModules)
+    {
+        if (target == module.name)
+            prefix = module.parameterPrefix;
+    }
+
+    for (auto *parameter : processor.getParameters())
+    {
+        if (auto *floatParameter = dynamic_cast<juce::AudioParameterFloat *>(parameter))
+        {
+            // Options, the preset morph and the modulation matrix are not module parameters, so they stay put
+            const auto id = floatParameter->getParameterID();
+
+            if (id.startsWith("Processing ") || id.startsWith("Preset ") || id.startsWith("Mod "))
+                continue;
+
+            if (target == chainName || id.startsWith(prefix))
+                parameters.add(floatParameter);
+        }
+    }
+
+    return parameters;
+}
+
+// Routes every modulation slot, cycling through the sources, to the target's float parameters
+void setModulationRoutings(AudioPluginAudioProcessor &processor, const juce::String &target)
+{
+    const auto parameters = getAutomatedParameters(processor, target);
+
+    for (int slot = 0; slot < static_cast<int>(ModulationMatrix::maxRoutings); ++slot)
+    {
+        const auto prefix = "Mod Slot " + juce::String(slot + 1) + " ";
+        auto *source = dynamic_cast<juce::AudioParameterChoice *>(processor.apvts.getParameter(prefix + "Source"));
+        auto *destination = dynamic_cast<juce::AudioParameterChoice *>(processor.apvts.getParameter(prefix + "Target"));
+        auto *amount = processor.apvts.getParameter(prefix + "Amount %");
+        jassert(source != nullptr && destination != nullptr && amount != nullptr);
+
+        const auto sourceIndex = 1 + slot % static_cast<int>(ModulationMatrix::numSources); // 0 is Off
+        const auto targetIndex = destination->choices.indexOf(parameters[slot % parameters.size()]->getParameterID());
+
+        source->setValueNotifyingHost(source->convertTo0to1(static_cast<float>(sourceIndex)));
+        destination->setValueNotifyingHost(destination->convertTo0to1(static_cast<float>(targetIndex)));
+        amount->setValueNotifyingHost(amount->convertTo0to1(50.0f));
+    }
+}
+
+// Flips the bypass of the target (of every module for the chain)
+void toggleBypasses(AudioPluginAudioProcessor &processor, const juce::String &target)
+{
+    for (const auto &module : benchmarkModules)
+    {
+        if (target != chainName && target != module.name)
+            continue;
+
+        auto *bypass = processor.apvts.getParameter(module.bypassID);
+        bypass->setValueNotifyingHost(bypass->getValue() > 0.5f ? 0.0f : 1.0f);
+    }
+}
+
+// The current order rotated by one slot
+AudioPluginAudioProcessor::DSP_ORDER rotateOrder(const AudioPluginAudioProcessor::DSP_ORDER &order)
+{
+    AudioPluginAudioProcessor::DSP_ORDER rotated;
+
+    for (size_t i = 1; i <= order.size(); ++i)
+        rotated.push_back(order[i % order.size()]);
+
+    return rotated;
+}
+
+BenchmarkResult runCase(const juce::String &target, ParameterState state, int numChannels, double sampleRate,
+                        int blockSize, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    setModuleBypasses(processor, target, state == ParameterState::Bypassed);
+
+    if (state == ParameterState::Modulated)
+        setModulationRoutings(processor, target);
+
+    const auto automated = state == ParameterState::Automated ? getAutomatedParameters(processor, target)
+                                                              : juce::Array<juce::RangedAudioParameter *>();
+
+    const auto automationIncrement = juce::MathConstants<double>::twoPi * automationRateHz * blockSize / sampleRate;
+    const auto togglePeriodBlocks = juce::jmax(1, juce::roundToInt(togglePeriodSeconds * sampleRate / blockSize));
+    double automationPhase = 0.0;
+
+    const auto nsPerSample = timeProcessBlock(processor, numChannels, sampleRate, blockSize, options, [&](int blockIndex, StopWatch &stopWatch)
+    {
+        if (blockIndex % togglePeriodBlocks == 0)
+        {
+            if (state == ParameterState::Toggled)
+            {
+                toggleBypasses(processor, target);
+            }
+            else if (state == ParameterState::Reordered)
+            {
+                stopWatch.stop();
+                processor.setDSPOrder(rotateOrder(processor.getDSPOrder()));
+                stopWatch.start();
+            }
+        }
+
+        if (!automated.isEmpty())
+        {
+            const auto value = static_cast<float>(0.5 + 0.45 * std::sin(automationPhase));
+            automationPhase += automationIncrement;
+
+            for (auto *parameter : automated)
+                parameter->setValueNotifyingHost(value);
+        }
+    }, state == ParameterState::Silent);
+
+    BenchmarkResult result;
+    result.suite = "processor";
+    result.name = target + "/" + getStateName(state) + "/" + juce::String(blockSize) + "/" + juce::String(numChannels) + "ch/" +
+                  juce::String(juce::roundToInt(sampleRate)) + "Hz";
+    result.properties.set("module", target);
+    result.properties.set("state", getStateName(state));
+    result.properties.set("blockSize", blockSize);
+    result.properties.set("channels", numChannels);
+    result.properties.set("sampleRate", sampleRate);
+    result.nsPerSample = nsPerSample;
+    return result;
+}
+} // namespace
+
+void runProcessorBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    juce::StringArray targets;
+
+    for (const auto &module : benchmarkModules)
+        targets.add(module.name);
+
+    targets.add(chainName);
+
+    for (const auto &target : targets)
+    {
+        if (!options.modules.isEmpty() && !options.modules.contains(target))
+            continue;
+
+        for (int s = 0; s < static_cast<int>(ParameterState::END_OF_LIST); ++s)
+        {
+            const auto state = static_cast<ParameterState>(s);
+
+            // With every module bypassed (or asleep) the target makes no difference, and a reorder only means
+            // something for the whole chain, so only the chain runs these states
+            const auto chainOnly = state == ParameterState::Bypassed || state == ParameterState::Reordered ||
+                                   state == ParameterState::Silent;
+
+            if (chainOnly && target != chainName)
+                continue;
+
+            if (!options.states.isEmpty() && !options.states.contains(getStateName(state)))
+                continue;
+
+            for (auto sampleRate : options.sampleRates)
+            {
+                for (auto numChannels : options.channelCounts)
+                {
+                    for (auto blockSize : options.blockSizes)
+                    {
+                        results.push_back(runCase(target, state, numChannels, sampleRate, blockSize, options));
+
+                        const auto &result = results.back();
+                        std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
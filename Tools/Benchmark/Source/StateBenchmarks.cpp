@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    State suite: time per call of saving and loading the plugin state, in
+    the binary format getStateInformation writes and in the XML format
+    (APVTS ValueTree -> XmlElement -> copyXmlToBinary) it replaced, plus the
+    size of each blob.
+
+    Loads go through setStateInformation, which still reads XML blobs, so
+    both formats are measured on the real load path. The processor is never
+    prepared, so a load only restores the order without building a chain.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+constexpr int callsPerRepeat = 200;
+
+// The XML blob as getStateInformation used to write it
+void writeXmlState(AudioPluginAudioProcessor &processor, juce::MemoryBlock &destData)
+{
+    auto state = processor.apvts.copyState();
+    juce::StringArray order;
+
+    for (auto option : processor.getDSPOrder())
+        order.add(juce::String(static_cast<int>(option)));
+
+    state.setProperty("dspOrder", order.joinIntoString(","), nullptr);
+
+    if (auto xml = state.createXml())
+    {
+        destData.reset();
+        juce::AudioProcessor::copyXmlToBinary(*xml, destData);
+    }
+}
+
+// Moves every parameter off its default, so neither format gets to store trivial values
+void setNonDefaultState(AudioPluginAudioProcessor &processor)
+{
+    juce::Random random(0x5eed);
+
+    for (auto *parameter : processor.getParameters())
+        parameter->setValueNotifyingHost(random.nextFloat());
+}
+
+BenchmarkResult makeResult(const juce::String &operation, const juce::String &format, size_t bytes, double nsPerCall)
+{
+    BenchmarkResult result;
+    result.suite = "state";
+    result.name = "State/" + operation + "/" + format;
+    result.properties.set("operation", operation);
+    result.properties.set("format", format);
+    result.properties.set("bytes", static_cast<int>(bytes));
+    result.nsPerSample = nsPerCall;
+    return result;
+}
+} // namespace
+
+void runStateBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    AudioPluginAudioProcessor processor;
+    setNonDefaultState(processor);
+
+    juce::MemoryBlock binary, xml;
+    processor.getStateInformation(binary);
+    writeXmlState(processor, xml);
+
+    const auto timeCalls = [&](auto &&call)
+    {
+        return measureNsPerSample(options.repeats, callsPerRepeat, [&](StopWatch &stopWatch)
+        {
+            stopWatch.start();
+
+            for (int i = 0; i < callsPerRepeat; ++i)
+                call();
+
+            stopWatch.stop();
+        });
+    };
+
+    juce::MemoryBlock scratch;
+
+    results.push_back(makeResult("Save", "Binary", binary.getSize(), timeCalls([&] { processor.getStateInformation(scratch); })));
+    results.push_back(makeResult("Save", "XML", xml.getSize(), timeCalls([&] { writeXmlState(processor, scratch); })));
+    results.push_back(makeResult("Load", "Binary", binary.getSize(), timeCalls([&]
+    {
+        processor.setStateInformation(binary.getData(), static_cast<int>(binary.getSize()));
+    })));
+    results.push_back(makeResult("Load", "XML", xml.getSize(), timeCalls([&]
+    {
+        processor.setStateInformation(xml.getData(), static_cast<int>(xml.getSize()));
+    })));
+
+    for (auto it = results.end() - 4; it != results.end(); ++it)
+    {
+        std::cout << it->name << ": " << juce::String(it->nsPerSample / 1000.0, 2) << " us/call, "
+                  << it->properties.getWithDefault("bytes", 0).toString() << " bytes" << std::endl;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    Sub-block suite: ns/sample of the full chain through processBlock for
+    every "Processing Sub Block" choice, with 2048-sample host blocks and
+    fused tiling off, so the option alone sets the sub-block size.
+
+    "Static" leaves the parameters alone, so the gap between the sizes is
+    the per-sub-block overhead (smoothing, reconfiguration, the chain's
+    dispatch) against the work it is spread over. "Automated" sweeps every
+    module parameter once per host block; the chain then runs at most
+    maxControlStepSamples per sub-block while the ramps move, so the larger
+    choices converge on the 32-sample figure.
+
+    --channels and --sample-rates apply as usual.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+constexpr int subBlockHostBlockSize = 2048;
+
+// Slow enough to stay within the smoothing time, fast enough to keep every module ramping
+constexpr double automationRateHz = 2.0;
+
+double timeSubBlocks(size_t sizeIndex, bool automated, int numChannels, double sampleRate, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    processor.setFusedTiling(false);
+
+    auto *subBlock = processor.apvts.getParameter("Processing Sub Block");
+    subBlock->setValueNotifyingHost(subBlock->convertTo0to1(static_cast<float>(sizeIndex)));
+
+    juce::Array<juce::RangedAudioParameter *> parameters;
+
+    for (auto *parameter : processor.getParameters())
+    {
+        if (auto *floatParameter = dynamic_cast<juce::AudioParameterFloat *>(parameter))
+        {
+            const auto id = floatParameter->getParameterID();
+
+            if (automated && !id.startsWith("Processing ") && !id.startsWith("Preset ") && !id.startsWith("Mod "))
+                parameters.add(floatParameter);
+        }
+    }
+
+    const auto automationIncrement = juce::MathConstants<double>::twoPi * automationRateHz * subBlockHostBlockSize / sampleRate;
+    double automationPhase = 0.0;
+
+    return timeProcessBlock(processor, numChannels, sampleRate, subBlockHostBlockSize, options, [&](int, StopWatch &)
+    {
+        const auto value = static_cast<float>(0.5 + 0.45 * std::sin(automationPhase));
+        automationPhase += automationIncrement;
+
+        for (auto *parameter : parameters)
+            parameter->setValueNotifyingHost(value);
+    });
+}
+} // namespace
+
+void runSubBlockBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    const auto &sizes = AudioPluginAudioProcessor::getSubBlockSizes();
+
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto numChannels : options.channelCounts)
+        {
+            for (auto automated : {false, true})
+            {
+                const juce::String state = automated ? "Automated" : "Static";
+
+                for (size_t i = 0; i < sizes.size(); ++i)
+                {
+                    const auto subBlockSize = sizes[i] > 0 ? sizes[i] : subBlockHostBlockSize;
+
+                    BenchmarkResult result;
+                    result.suite = "subblock";
+                    result.name = "SubBlock/" + state + "/" + juce::String(subBlockSize) + "/" + juce::String(numChannels) + "ch/" +
+                                  juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                    result.properties.set("state", state);
+                    result.properties.set("subBlockSize", subBlockSize);
+                    result.properties.set("blockSize", subBlockHostBlockSize);
+                    result.properties.set("channels", numChannels);
+                    result.properties.set("sampleRate", sampleRate);
+                    result.nsPerSample = timeSubBlocks(i, automated, numChannels, sampleRate, options);
+                    results.push_back(result);
+
+                    std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample" << std::endl;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Tiling suite: ns/sample of the full chain in the default order through
+    processBlock with "Processing Sub Block" on "Host Block", for host
+    blocks from 64 to 8192 samples.
+
+    "PerStage" runs every stage over the whole host buffer before the next
+    stage starts; "Fused" runs the whole chain on one cache tile at a time
+    (see AudioPluginAudioProcessor::getCacheTileSize). Below the tile size
+    the two are the same; above it the gap is what keeping the audio in L1
+    between stages is worth, less the cost of the extra parameter updates.
+
+    The suite keeps its own block sizes, since the range is the point of it;
+    --channels and --sample-rates apply as usual.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace
+{
+constexpr std::array<int, 8> tilingBlockSizes{64, 128, 256, 512, 1024, 2048, 4096, 8192};
+
+double timeChain(bool fused, int numChannels, double sampleRate, int blockSize, const BenchmarkOptions &options)
+{
+    AudioPluginAudioProcessor processor;
+    processor.setFusedTiling(fused);
+
+    auto *subBlock = processor.apvts.getParameter("Processing Sub Block");
+    subBlock->setValueNotifyingHost(subBlock->convertTo0to1(static_cast<float>(AudioPluginAudioProcessor::getSubBlockSizes().size() - 1)));
+
+    return timeProcessBlock(processor, numChannels, sampleRate, blockSize, options);
+}
+} // namespace
+
+void runTilingBenchmarks(const BenchmarkOptions &options, BenchmarkResults &results)
+{
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto numChannels : options.channelCounts)
+        {
+            const auto tileSize = static_cast<int>(AudioPluginAudioProcessor::getCacheTileSize(static_cast<size_t>(numChannels)));
+
+            for (auto blockSize : tilingBlockSizes)
+            {
+                for (auto fused : {false, true})
+                {
+                    const juce::String mode = fused ? "Fused" : "PerStage";
+
+                    BenchmarkResult result;
+                    result.suite = "tiling";
+                    result.name = "Tiling/" + mode + "/" + juce::String(blockSize) + "/" +
+                                  juce::String(numChannels) + "ch/" + juce::String(juce::roundToInt(sampleRate)) + "Hz";
+                    result.properties.set("mode", mode);
+                    result.properties.set("blockSize", blockSize);
+                    result.properties.set("tileSize", fused ? juce::jmin(tileSize, blockSize) : blockSize);
+                    result.properties.set("channels", numChannels);
+                    result.properties.set("sampleRate", sampleRate);
+                    result.nsPerSample = timeChain(fused, numChannels, sampleRate, blockSize, options);
+                    results.push_back(result);
+
+                    std::cout << result.name << ": " << juce::String(result.nsPerSample, 2) << " ns/sample" << std::endl;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    Stand-in for the Projucer generated JucePluginDefines.h, so the console
+    tools in Tools/ can compile Source/PluginProcessor.cpp outside a plugin
+    target. Keep these in sync with Audio-Plugin.jucer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#define JucePlugin_Name "Audio-Plugin"
+#define JucePlugin_IsSynth 0
+#define JucePlugin_WantsMidiInput 0
+#define JucePlugin_ProducesMidiOutput 0
+#define JucePlugin_IsMidiEffect 0
@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    Headless offline renderer.
+
+    Loads a saved plugin state (a blob written by getStateInformation, or a
+    plain XML state file) into AudioPluginAudioProcessor
+    and renders WAV files through processBlock at a fixed block size and
+    sample rate. Files are shared out to a pool of workers, each of which
+    owns its own processor instance.
+
+    Usage:
+      OfflineRender --preset=<state file> [--block-size=512] [--sample-rate=48000]
+                    [--jobs=<workers>] [--bits=24] [--out-dir=<dir>] <input.wav> ...
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+// Input channels past the widest layout the plugin accepts are dropped
+constexpr int maxChannels = AudioPluginAudioProcessor::maxNumChannels;
+
+// Padding after the source so the resampler can always read past the last input sample
+constexpr int resamplerPadding = 8;
+
+struct RenderSettings
+{
+    juce::MemoryBlock state;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int bitsPerSample = 24;
+    juce::File outputDirectory;
+};
+
+struct RenderResult
+{
+    juce::File input;
+    juce::String error;
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;
+};
+
+// Reads the preset file as XML if it parses as such, otherwise as a raw state blob (binary, or XML from older versions)
+bool loadState(const juce::File &file, juce::MemoryBlock &destData)
+{
+    if (!file.loadFileAsData(destData) || destData.isEmpty())
+        return false;
+
+    if (auto xml = juce::parseXML(file))
+    {
+        destData.reset();
+        juce::AudioProcessor::copyXmlToBinary(*xml, destData);
+    }
+
+    return true;
+}
+
+// Reads the whole file and converts it to the render sample rate
+bool readInput(juce::AudioFormatManager &formatManager, const juce::File &file, double sampleRate,
+               juce::AudioBuffer<float> &destination, juce::String &error)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+    {
+        error = "cannot read " + file.getFullPathName();
+        return false;
+    }
+
+    const auto numChannels = juce::jmin(static_cast<int>(reader->numChannels), maxChannels);
+    const auto numSamples = static_cast<int>(reader->lengthInSamples);
+
+    if (numChannels == 0 || numSamples == 0)
+    {
+        error = "no audio in " + file.getFullPathName();
+        return false;
+    }
+
+    juce::AudioBuffer<float> source(numChannels, numSamples + resamplerPadding);
+    source.clear();
+    reader->read(&source, 0, numSamples, 0, true, numChannels > 1);
+
+    if (reader->sampleRate == sampleRate)
+    {
+        destination.makeCopyOf(source);
+        destination.setSize(numChannels, numSamples, true);
+        return true;
+    }
+
+    const auto ratio = reader->sampleRate / sampleRate;
+    const auto numOutputSamples = juce::jmax(1, static_cast<int>(std::ceil(numSamples / ratio)));
+
+    destination.setSize(numChannels, numOutputSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        juce::LagrangeInterpolator interpolator;
+        interpolator.process(ratio, source.getReadPointer(ch), destination.getWritePointer(ch), numOutputSamples);
+    }
+
+    return true;
+}
+
+//==============================================================================
+// One worker: a processor instance that renders files until the queue runs dry
+class RenderWorker : public juce::ThreadPoolJob
+{
+public:
+    RenderWorker(const RenderSettings &settingsToUse, std::vector<RenderResult> &resultsToFill, std::atomic<size_t> &nextIndexToClaim)
+        : juce::ThreadPoolJob("Render Worker"), settings(settingsToUse), results(resultsToFill), nextIndex(nextIndexToClaim)
+    {
+        // The processor is built and its state restored on the message thread; only rendering happens on the pool
+        processor.setNonRealtime(true);
+        processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+        formatManager.registerBasicFormats();
+    }
+
+    JobStatus runJob() override
+    {
+        for (auto index = nextIndex.fetch_add(1); index < results.size(); index = nextIndex.fetch_add(1))
+        {
+            if (shouldExit())
+                break;
+
+            render(results[index]);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    void render(RenderResult &result)
+    {
+        juce::AudioBuffer<float> audio;
+
+        if (!readInput(formatManager, result.input, settings.sampleRate, audio, result.error))
+            return;
+
+        const auto numChannels = audio.getNumChannels();
+        const auto numSamples = audio.getNumSamples();
+
+        processor.setPlayConfigDetails(numChannels, numChannels, settings.sampleRate, settings.blockSize);
+        processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+
+        // Render the latency and the tail as well, then drop the latency so the output lines up with the input
+        const auto latency = processor.getLatencySamples();
+        const auto tail = static_cast<int>(std::ceil(processor.getTailLengthSeconds() * settings.sampleRate));
+        const auto totalSamples = numSamples + latency + tail;
+
+        audio.setSize(numChannels, totalSamples, true, true);
+
+        juce::MidiBuffer midi;
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        for (int position = 0; position < totalSamples; position += settings.blockSize)
+        {
+            const auto blockLength = juce::jmin(settings.blockSize, totalSamples - position);
+            juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), numChannels, position, blockLength);
+
+            processor.processBlock(block, midi);
+            midi.clear();
+        }
+
+        result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+        result.audioSeconds = totalSamples / settings.sampleRate;
+
+        processor.releaseResources();
+
+        write(result, audio, latency, numSamples + tail);
+    }
+
+    void write(RenderResult &result, const juce::AudioBuffer<float> &audio, int startSample, int numSamples)
+    {
+        auto output = settings.outputDirectory.getChildFile(result.input.getFileNameWithoutExtension() + ".wav");
+
+        if (output == result.input)
+            output = output.getSiblingFile(result.input.getFileNameWithoutExtension() + "_rendered.wav");
+
+        output.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(output);
+
+        if (stream->failedToOpen())
+        {
+            result.error = "cannot write " + output.getFullPathName();
+            return;
+        }
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), settings.sampleRate,
+                                                                            static_cast<unsigned int>(audio.getNumChannels()),
+                                                                            settings.bitsPerSample, {}, 0));
+
+        if (writer == nullptr)
+        {
+            result.error = "unsupported output format for " + output.getFullPathName();
+            return;
+        }
+
+        stream.release(); // now owned by the writer
+
+        if (!writer->writeFromAudioSampleBuffer(audio, startSample, numSamples))
+            result.error = "failed writing " + output.getFullPathName();
+    }
+
+    const RenderSettings &settings;
+    std::vector<RenderResult> &results;
+    std::atomic<size_t> &nextIndex;
+
+    AudioPluginAudioProcessor processor;
+    juce::AudioFormatManager formatManager;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: OfflineRender --preset=<state file> [--block-size=512] [--sample-rate=48000]\n"
+                 "                     [--jobs=<workers>] [--bits=24] [--out-dir=<dir>] <input.wav> ...\n";
+}
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    RenderSettings settings;
+    std::vector<RenderResult> results;
+
+    for (const auto &argument : args.arguments)
+    {
+        if (!argument.isOption())
+        {
+            RenderResult result;
+            result.input = argument.resolveAsFile();
+            results.push_back(result);
+        }
+    }
+
+    if (!args.containsOption("--preset") || results.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto presetFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--preset"));
+
+    if (!loadState(presetFile, settings.state))
+    {
+        std::cerr << "Cannot load preset " << presetFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (args.containsOption("--sample-rate"))
+        settings.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+
+    if (args.containsOption("--block-size"))
+        settings.blockSize = args.getValueForOption("--block-size").getIntValue();
+
+    if (args.containsOption("--bits"))
+        settings.bitsPerSample = args.getValueForOption("--bits").getIntValue();
+
+    settings.outputDirectory = args.containsOption("--out-dir")
+                                   ? juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out-dir"))
+                                   : juce::File::getCurrentWorkingDirectory();
+
+    if (settings.sampleRate <= 0.0 || settings.blockSize <= 0)
+    {
+        std::cerr << "Sample rate and block size must be positive\n";
+        return 1;
+    }
+
+    if (!settings.outputDirectory.createDirectory().wasOk())
+    {
+        std::cerr << "Cannot create " << settings.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    auto numWorkers = args.containsOption("--jobs") ? args.getValueForOption("--jobs").getIntValue()
+                                                    : juce::SystemStats::getNumCpus();
+    numWorkers = juce::jlimit(1, static_cast<int>(results.size()), numWorkers);
+
+    std::atomic<size_t> nextIndex{0};
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<RenderWorker>(settings, results, nextIndex));
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(numWorkers);
+
+        for (auto &worker : workers)
+            pool.addJob(worker.get(), false);
+
+        for (auto &worker : workers)
+            pool.waitForJobToFinish(worker.get(), -1);
+    }
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    double totalAudioSeconds = 0.0;
+    int failures = 0;
+
+    for (const auto &result : results)
+    {
+        if (result.error.isNotEmpty())
+        {
+            std::cerr << result.input.getFileName() << ": " << result.error << "\n";
+            ++failures;
+            continue;
+        }
+
+        totalAudioSeconds += result.audioSeconds;
+        std::cout << result.input.getFileName() << ": " << juce::String(result.audioSeconds, 2) << " s rendered in "
+                  << juce::String(result.renderSeconds, 3) << " s ("
+                  << juce::String(result.audioSeconds / juce::jmax(result.renderSeconds, 1.0e-9), 1) << "x realtime)\n";
+    }
+
+    std::cout << "Total: " << juce::String(totalAudioSeconds, 2) << " s of audio in " << juce::String(wallSeconds, 3)
+              << " s on " << numWorkers << " worker(s) (" << juce::String(totalAudioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1)
+              << "x realtime)\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    Real-time safety stress test.
+
+    Built with AUDIO_PLUGIN_RT_CHECK=1, so every heap allocation,
+    deallocation and blocking lock inside processBlock is counted. First, for
+    each General Filter mode, only the frequency, Q and gain are automated
+    through the host parameters. Then the stress runs drive the full chain
+    with randomised block sizes, parameter automation (including bypasses,
+    modes and oversampling), chain changes (random lengths and repeated
+    modules) and program recalls. Fails if any violation was seen. Buses
+    wider than stereo run their channel groups on the worker pool, whose
+    tasks are checked like the audio thread.
+
+    Usage:
+      RealtimeCheck [--seconds=<audio per configuration>] [--seed=<n>] [--max-block=<samples>]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <random>
+#include "../../../Source/PluginProcessor.h"
+
+#if !AUDIO_PLUGIN_RT_CHECK
+ #error "RealtimeCheck must be built with AUDIO_PLUGIN_RT_CHECK=1"
+#endif
+
+namespace
+{
+// Chance per block of automating the parameters, and of each parameter moving when that happens
+constexpr float automationProbability = 0.5f;
+constexpr float parameterMoveProbability = 0.2f;
+
+// Chance per block of requesting a new processing order
+constexpr float reorderProbability = 0.02f;
+
+// Chance per block of recalling a program, and of storing the current state into one
+constexpr float programChangeProbability = 0.02f;
+constexpr float programStoreProbability = 0.01f;
+
+// Worker threads for the buses wider than stereo
+constexpr int wideBusWorkers = 3;
+
+// Cycles per second of the General Filter's frequency, Q and gain automation; unrelated, so the three move independently
+constexpr double frequencyRateHz = 1.3;
+constexpr double qualityRateHz = 0.7;
+constexpr double gainRateHz = 2.1;
+constexpr int filterBlockSize = 256;
+
+struct StressSettings
+{
+    double secondsPerConfiguration = 10.0;
+    int maxBlockSize = 2048;
+    unsigned int seed = 1;
+};
+
+// Renders noise through processBlock in every General Filter mode while only its frequency, Q and gain sweep,
+// printing the violations per mode
+void checkFilterAutomation(const StressSettings &settings, double sampleRate, int numChannels)
+{
+    AudioPluginAudioProcessor processor;
+    auto &apvts = processor.apvts;
+
+    auto *mode = dynamic_cast<juce::AudioParameterChoice *>(apvts.getParameter("General Filter Mode"));
+    auto *frequency = apvts.getParameter("General Filter Frequency Hz");
+    auto *quality = apvts.getParameter("General Filter Quality");
+    auto *gain = apvts.getParameter("General Filter Gain dB");
+    jassert(mode != nullptr && frequency != nullptr && quality != nullptr && gain != nullptr);
+
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, filterBlockSize);
+    processor.prepareToPlay(sampleRate, filterBlockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, filterBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(static_cast<juce::int64>(settings.seed));
+
+    const auto numBlocks = juce::roundToInt(settings.secondsPerConfiguration * sampleRate / filterBlockSize);
+
+    for (int modeIndex = 0; modeIndex < mode->choices.size(); ++modeIndex)
+    {
+        // Setting parameters plays the part of the host, so it may allocate freely
+        *mode = modeIndex;
+
+        const auto before = RealtimeChecker::getTotalViolations();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto time = static_cast<double>(block) * filterBlockSize / sampleRate;
+            const auto sweep = [time](double rateHz) { return static_cast<float>(0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * rateHz * time)); };
+
+            frequency->setValueNotifyingHost(sweep(frequencyRateHz));
+            quality->setValueNotifyingHost(sweep(qualityRateHz));
+            gain->setValueNotifyingHost(sweep(gainRateHz));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto *data = buffer.getWritePointer(ch);
+
+                for (int i = 0; i < filterBlockSize; ++i)
+                    data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.5f;
+            }
+
+            processor.processBlock(buffer, midi);
+        }
+
+        std::cout << juce::String(sampleRate, 0) << " Hz, " << numChannels << " channel(s), General Filter "
+                  << mode->choices[modeIndex] << ": " << RealtimeChecker::getTotalViolations() - before << " violation(s)\n";
+    }
+
+    processor.releaseResources();
+}
+
+// Any length from empty to full, with repeated modules
+AudioPluginAudioProcessor::DSP_ORDER makeRandomOrder(std::mt19937 &generator)
+{
+    using DSP_OPTION = AudioPluginAudioProcessor::DSP_OPTION;
+
+    std::uniform_int_distribution<size_t> lengths(0, AudioPluginAudioProcessor::maxChainLength);
+    std::uniform_int_distribution<int> options(0, static_cast<int>(DSP_OPTION::END_OF_LIST) - 1);
+
+    AudioPluginAudioProcessor::DSP_ORDER order;
+
+    for (auto length = lengths(generator); order.size() < length;)
+        order.push_back(static_cast<DSP_OPTION>(options(generator)));
+
+    return order;
+}
+
+void runStress(const StressSettings &settings, double sampleRate, int numChannels)
+{
+    AudioPluginAudioProcessor processor;
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.maxBlockSize);
+    processor.prepareToPlay(sampleRate, settings.maxBlockSize);
+
+    // Wide buses split into channel groups on the worker pool for every sub-block, so the workers are checked too
+    if (numChannels > 2)
+    {
+        processor.setWorkerThreads(wideBusWorkers);
+        processor.setParallelThreshold(0);
+    }
+
+    std::mt19937 generator(settings.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> blockSizes(1, settings.maxBlockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, settings.maxBlockSize);
+    juce::MidiBuffer midi;
+
+    const auto totalSamples = static_cast<juce::int64>(settings.secondsPerConfiguration * sampleRate);
+
+    for (juce::int64 rendered = 0; rendered < totalSamples;)
+    {
+        // Everything outside processBlock plays the part of the host and message thread, so it may allocate freely
+        if (unit(generator) < automationProbability)
+        {
+            for (auto *parameter : processor.getParameters())
+            {
+                if (unit(generator) < parameterMoveProbability)
+                    parameter->setValueNotifyingHost(unit(generator));
+            }
+        }
+
+        if (unit(generator) < reorderProbability)
+            processor.setDSPOrder(makeRandomOrder(generator));
+
+        // Recalls and morphs must stay allocation-free on the audio thread; storing may allocate here
+        if (unit(generator) < programStoreProbability)
+            processor.storePreset(static_cast<int>(unit(generator) * AudioPluginAudioProcessor::numPresets) % AudioPluginAudioProcessor::numPresets);
+
+        if (unit(generator) < programChangeProbability)
+            processor.setCurrentProgram(static_cast<int>(unit(generator) * AudioPluginAudioProcessor::numPresets) % AudioPluginAudioProcessor::numPresets);
+
+        const auto numSamples = blockSizes(generator);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto *data = buffer.getWritePointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = (unit(generator) * 2.0f - 1.0f) * 0.5f;
+        }
+
+        processor.processBlock(buffer, midi);
+        rendered += numSamples;
+    }
+
+    processor.releaseResources();
+}
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    StressSettings settings;
+
+    if (args.containsOption("--seconds"))
+        settings.secondsPerConfiguration = juce::jmax(0.01, args.getValueForOption("--seconds").getDoubleValue());
+
+    if (args.containsOption("--max-block"))
+        settings.maxBlockSize = juce::jmax(1, args.getValueForOption("--max-block").getIntValue());
+
+    if (args.containsOption("--seed"))
+        settings.seed = static_cast<unsigned int>(args.getValueForOption("--seed").getLargeIntValue());
+
+    using Violation = RealtimeChecker::Violation;
+    RealtimeChecker::resetViolations();
+
+    for (auto sampleRate : {44100.0, 96000.0})
+    {
+        for (auto numChannels : {1, 2})
+            checkFilterAutomation(settings, sampleRate, numChannels);
+    }
+
+    for (auto sampleRate : {44100.0, 96000.0})
+    {
+        for (auto numChannels : {1, 2, 6, AudioPluginAudioProcessor::maxNumChannels})
+        {
+            const auto before = RealtimeChecker::getTotalViolations();
+            runStress(settings, sampleRate, numChannels);
+
+            std::cout << juce::String(sampleRate, 0) << " Hz, " << numChannels << " channel(s): "
+                      << RealtimeChecker::getTotalViolations() - before << " violation(s)\n";
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(Violation::END_OF_LIST); ++i)
+    {
+        const auto kind = static_cast<Violation>(i);
+        std::cout << RealtimeChecker::getViolationName(kind) << ": " << RealtimeChecker::getNumViolations(kind) << "\n";
+    }
+
+    const auto total = RealtimeChecker::getTotalViolations();
+    std::cout << (total == 0 ? "PASSED" : "FAILED") << " (seed " << static_cast<juce::int64>(settings.seed) << ")\n";
+
+    return total == 0 ? 0 : 1;
+}